@@ -1195,10 +1195,26 @@ RuntimeEditor::RuntimeEditor(QWidget *parent)
 
 
     //End Hima
+    // Binary recordings: the timeline scrubs the replay and follows the playhead
+    connect(runtime->recorder, &Recorder::replayLoaded, loggerDialog, [=](double durationSeconds) {
+        loggerDialog->setReplayDuration(static_cast<qint64>(durationSeconds * 1000.0));
+    });
+    connect(runtime->recorder, &Recorder::replayPositionChanged, loggerDialog, [=](double seconds) {
+        loggerDialog->setReplayPosition(static_cast<qint64>(seconds * 1000.0));
+    });
+    connect(loggerDialog, &LoggerDialog::seekRecording, this, [=](qint64 timestampMs) {
+        runtime->recorder->seekTo(timestampMs / 1000.0);
+    });
+    connect(loggerDialog, &LoggerDialog::replaySpeedChanged, runtime->recorder, &Recorder::setReplaySpeed);
+
     connect(loggerDialog, &LoggerDialog::replayRecording, this, [=](const QString &filePath) {
         simulation->stop();
         tacticalDisplay->canvas->Render(0.016f);
         if (!filePath.isEmpty() && runtime->recorder->loadFromFile(filePath)) {
+            if (runtime->recorder->hasReplay()) {
+                qDebug() << "Replay started using file:" << filePath;
+                return;
+            }
             QVector<QJsonObject> frames = runtime->recorder->getRecordedFrames();
             if (!frames.isEmpty()) {
                 simulation->replay(frames);
@@ -1289,9 +1305,13 @@ RuntimeEditor::RuntimeEditor(QWidget *parent)
                 this,
                 "Select Replay File",
                 QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/recordings",
-                "*.json"
+                "*.tdfr *.json"
                 );
             if (!filePath.isEmpty() && runtime->recorder->loadFromFile(filePath)) {
+                if (runtime->recorder->hasReplay()) {
+                    qDebug() << "Replay started using file:" << filePath;
+                    return;
+                }
                 QVector<QJsonObject> frames = runtime->recorder->getRecordedFrames();
                 if (!frames.isEmpty()) {
                     simulation->replay(frames);
@@ -1303,16 +1323,8 @@ RuntimeEditor::RuntimeEditor(QWidget *parent)
                 qWarning() << "Replay cancelled or file failed to load.";
             }
         });
+        // The time scale is the only place speed applies; models move at their own speed
         connect(runtimeToolBar, &RuntimeToolBar::speedChanged, simulation, &Simulation::setSpeed);
-        connect(runtimeToolBar, &RuntimeToolBar::speedChanged, this, [=](int speed) {
-            float moveSpeed = static_cast<float>(speed);
-            for (auto& [id, comp] : simulation->physicsComponent) {
-                if (comp.dynamicModel) {
-                    comp.dynamicModel->setMoveSpeed(moveSpeed);
-                }
-            }
-            qDebug() << "Simulation speed set to:" << speed << "(moveSpeed:" << moveSpeed << ")";
-        });
         networkToolBar->setNetworkManager(networkManager);
     } else {
         qWarning() << "Failed to connect RuntimeToolBar signals - nullptr detected";
@@ -1350,7 +1362,32 @@ RuntimeEditor::RuntimeEditor(QWidget *parent)
     if (tacticalDisplay && tacticalDisplay->canvas) {
         connect(tacticalDisplay->canvas, &CanvasWidget::selectEntitybyCursor,
                 treeView, &HierarchyTree::selectEntityById);
+
+        // As a client, the selected entity streams at full rate and otherwise
+        // only what the map shows; a server keeps streaming everything
+        connect(tacticalDisplay->canvas, &CanvasWidget::selectEntitybyCursor, networkManager, [=](QString ID) {
+            networkManager->setSelection({ID.toStdString()});
+        });
+        QTimer *interestTimer = new QTimer(this);
+        interestTimer->setSingleShot(true);
+        interestTimer->setInterval(200); // a drag repaints every frame
+        connect(tacticalDisplay->canvas, &CanvasWidget::visibleAreaChanged, interestTimer, [interestTimer]() {
+            if (!interestTimer->isActive()) interestTimer->start();
+        });
+        connect(interestTimer, &QTimer::timeout, networkManager, [=]() {
+            // Transforms hold latitude in x and longitude in z
+            const QRectF geo = tacticalDisplay->canvas->visibleArea();
+            InterestArea area;
+            area.shape = InterestArea::Box;
+            area.minimum = QVector3D(geo.top(), -1.0e6f, geo.left());
+            area.maximum = QVector3D(geo.bottom(), 1.0e6f, geo.right());
+            area.margin = 0.1f * std::max(geo.width(), geo.height()); // keeps entities just off screen
+            networkManager->setInterest(area);
+        });
     }
+    connect(treeView, &HierarchyTree::itemSelected, networkManager, [=](QVariantMap data) {
+        if (data["type"].toString() == "entity") networkManager->setSelection({data["ID"].toString().toStdString()});
+    });
     connect(treeView, &HierarchyTree::itemSelected, this, [=](QVariantMap data) {
         QString type;
         if (data["type"].type() == QVariant::Map) {
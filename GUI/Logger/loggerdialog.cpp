@@ -420,6 +420,18 @@ void LoggerDialog::setupUi()
     controlLayout->addWidget(replayRecordingButton);
     //End Hima
 
+    // Replay speed, independent of the simulation speed slider
+    QHBoxLayout *replaySpeedLayout = new QHBoxLayout();
+    replaySpeedBox = new QComboBox(this);
+    for (double speed : {-4.0, -1.0, 0.25, 0.5, 1.0, 2.0, 4.0, 16.0}) {
+        replaySpeedBox->addItem(QString("%1x").arg(speed), speed);
+    }
+    replaySpeedBox->setCurrentIndex(replaySpeedBox->findData(1.0));
+    replaySpeedLayout->addWidget(new QLabel(tr("Replay Speed"), this));
+    replaySpeedLayout->addWidget(replaySpeedBox);
+    replaySpeedLayout->addStretch();
+    controlLayout->addLayout(replaySpeedLayout);
+
     // Timeline widget
     timelineWidget = new TimelineWidget(this);
    timelineWidget->setVisible(true);
@@ -532,7 +544,7 @@ void LoggerDialog::setupUi()
             this,
             tr("Open Recording File"),
             QDir::homePath(),
-            tr("JSON Files (*.json)")
+            tr("Recordings (*.tdfr *.json)")
             );
 
         if (selectedFile.isEmpty())
@@ -544,6 +556,10 @@ void LoggerDialog::setupUi()
         qDebug() << "Recording loaded — file path:" << filePath;
     });
 
+    connect(replaySpeedBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        emit replaySpeedChanged(replaySpeedBox->itemData(index).toDouble());
+    });
+
     // Replay button: uses stored filePath
     connect(replayRecordingButton, &QPushButton::clicked, this, [this]() {
         if (filePath.isEmpty()) {
@@ -637,6 +653,8 @@ void LoggerDialog::setupUi()
         bookmarkDialog.exec();
     });
 
+    connect(timelineWidget, &TimelineWidget::seekRequested, this, &LoggerDialog::seekRecording);
+
     connect(timestampCheckBox, &QCheckBox::stateChanged, this, [this](int state) {
         bool enabled = (state == Qt::Checked);
         emit timestampToggled(enabled);
@@ -652,7 +670,7 @@ void LoggerDialog::updateRecordingsList()
 {
     recordingsList->clear();
     QStringList filters;
-    filters << "*.json";
+    filters << "*.tdfr" << "*.json";
     QStringList recordingFiles = QDir(recordingsDir).entryList(filters, QDir::Files, QDir::Time);
     for (const QString &file : recordingFiles) {
         QListWidgetItem *item = new QListWidgetItem(QIcon(":/icons/images/file.png"), file, recordingsList);
@@ -673,3 +691,16 @@ void LoggerDialog::addBookmarkWithTimestamp(const QString &note, qint64 timestam
         timelineWidget->addBookmark(note, timestampMs);
     }
 }
+
+/* Called once a recording is loaded for replay; the timeline becomes a scrub bar */
+void LoggerDialog::setReplayDuration(qint64 durationMs)
+{
+    timelineWidget->setRecordingDuration(durationMs);
+    timelineWidget->setScrubEnabled(durationMs > 0);
+    timelineWidget->setPlayhead(0);
+}
+
+void LoggerDialog::setReplayPosition(qint64 timestampMs)
+{
+    timelineWidget->setPlayhead(timestampMs);
+}
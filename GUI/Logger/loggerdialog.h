@@ -173,6 +173,7 @@
 #include <QDebug>
 #include <QDialog>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QLabel>
 #include <QListWidget>
 #include <QPushButton>
@@ -184,6 +185,7 @@
 #include <QPainter>
 #include <QWidget>
 #include <QDateTime>
+#include <QMouseEvent>
 //#include "core/Recorder/recorder.h"
 class TimelineWidget : public QWidget
 {
@@ -209,8 +211,28 @@ public:
         bookmarks.clear();
         update();
     }
+    // Replay scrubbing: clicks and drags seek, bookmarks snap
+    void setScrubEnabled(bool enabled) {
+        scrubEnabled = enabled;
+        setCursor(enabled ? Qt::PointingHandCursor : Qt::ArrowCursor);
+        update();
+    }
+    void setPlayhead(qint64 timestampMs) {
+        playheadMs = timestampMs;
+        update();
+    }
+
+signals:
+    void seekRequested(qint64 timestampMs);
 
 protected:
+    void mousePressEvent(QMouseEvent *event) override {
+        scrubTo(event->pos().x(), true);
+    }
+    void mouseMoveEvent(QMouseEvent *event) override {
+        if (event->buttons() & Qt::LeftButton) scrubTo(event->pos().x(), false);
+    }
+
     void paintEvent(QPaintEvent *event) override {
         QPainter painter(this);
         painter.setRenderHint(QPainter::Antialiasing);
@@ -252,11 +274,35 @@ protected:
                 painter.drawText(x + 5, margin + timelineY - 15, bookmark.first);
             }
         }
+
+        // Draw replay position
+        if (scrubEnabled && playheadMs >= 0 && playheadMs <= recordingDurationMs) {
+            int x = margin + (playheadMs * width) / recordingDurationMs;
+            painter.setPen(QPen(QColor(0, 120, 212), 2));
+            painter.drawLine(x, margin, x, margin + height);
+        }
     }
 
 private:
+    void scrubTo(int x, bool snapToBookmark) {
+        const int margin = 10;
+        const int width = this->width() - 2 * margin;
+        if (!scrubEnabled || recordingDurationMs <= 0 || width <= 0) return;
+        qint64 timestampMs = qBound<qint64>(0, (qint64(x - margin) * recordingDurationMs) / width, recordingDurationMs);
+        if (snapToBookmark) {
+            for (const auto &bookmark : bookmarks) {
+                int bx = margin + (bookmark.second * width) / recordingDurationMs;
+                if (qAbs(bx - x) <= 5) timestampMs = bookmark.second;
+            }
+        }
+        setPlayhead(timestampMs);
+        emit seekRequested(timestampMs);
+    }
+
     QDateTime recordingStartTime;
     qint64 recordingDurationMs = 0;
+    qint64 playheadMs = -1;
+    bool scrubEnabled = false;
     QList<QPair<QString, qint64>> bookmarks; // {note, timestampMs}
     //By Hima
     void saveRecordingToFile();   // <--- Add this new method
@@ -270,6 +316,8 @@ public:
     explicit LoggerDialog(QWidget *parent = nullptr);
     void updateRecordingDuration(qint64 durationMs);
     void addBookmarkWithTimestamp(const QString &note, qint64 timestampMs);
+    void setReplayDuration(qint64 durationMs);
+    void setReplayPosition(qint64 timestampMs);
 
 signals:
     void startRecording();
@@ -285,6 +333,8 @@ signals:
     void eventTypesSelected(QStringList eventTypes);
     void bookmarkAdded(const QString &bookmarkNote);
     void timestampToggled(bool enabled);
+    void seekRecording(qint64 timestampMs);
+    void replaySpeedChanged(double speed); // negative plays backwards
 
 private:
     void setupUi();
@@ -303,6 +353,7 @@ private:
     QString filePath;
     QPushButton *loadRecordingButton;
     QPushButton *replayRecordingButton;
+    QComboBox *replaySpeedBox;
     //QPushButton *saveRecordingButton;
     //End Hima
     QString recordingsDir;
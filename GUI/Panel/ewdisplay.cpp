@@ -62,9 +62,14 @@ void EWDisplay::selectEntity(Entity* entit)
     id = QString::fromStdString(platform->ID);
     entity = platform;
     // Select first valid sensor
+    disconnect(trackConnection);
+    tracks.clear();
     for (Sensor* s : entity->sensorList) {
         if (s) {
             sensor = s;
+            // Seed from the current table once, then follow the deltas
+            for (const Target &target : sensor->ewtargets) tracks.insert(target.entity, target);
+            trackConnection = connect(sensor, &Sensor::tracksChanged, this, &EWDisplay::applyTrackDeltas);
             // Set window title with platform name
             setWindowTitle("Radar Display (" + QString::fromStdString(entity->Name) + ")");
             qDebug() << "csdvfyjkygj";
@@ -78,6 +83,8 @@ void EWDisplay::RemoveEntity(QString ID)
 {
     if (id == ID) {
         // Clear entity and sensor
+        disconnect(trackConnection);
+        tracks.clear();
         entity = nullptr;
         sensor = nullptr;
         // Reset window title
@@ -86,6 +93,26 @@ void EWDisplay::RemoveEntity(QString ID)
 }
 
 // %%% Update Methods %%%
+/* Apply entered, updated and lost tracks of the EW channel */
+void EWDisplay::applyTrackDeltas(const std::vector<TrackDelta>& deltas)
+{
+    bool changed = false;
+    for (const TrackDelta &delta : deltas) {
+        if (!delta.ew) continue;
+        if (delta.kind == TrackDelta::Lost) {
+            tracks.remove(delta.entity);
+        } else {
+            Target &target = tracks[delta.entity];
+            target.entity = delta.entity;
+            target.angle = delta.angle;
+            target.radius = delta.radius;
+        }
+        changed = true;
+    }
+    // Repaint only when something changed
+    if (changed) update();
+}
+
 /* Update radar display data */
 void EWDisplay::updateRadar()
 {
@@ -151,7 +178,7 @@ void EWDisplay::drawTargetAndPath(QPainter &painter)
         // Get entity angle
         ang = entity->transform->toEulerAngles().y();
         painter.setBrush(Qt::red);
-        for (const Target &target : sensor->ewtargets) {
+        for (const Target &target : tracks) {
             // Calculate target position
             int panelhigh = outerRadius;
             float per = target.radius/range;
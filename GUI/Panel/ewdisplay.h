@@ -10,6 +10,7 @@
 #include "core/Hierarchy/hierarchy.h"             // For hierarchy data structure
 #include <QWidget>                                // For widget base class
 #include <QVector>                                // For vector container
+#include <QHash>                                  // For track table
 
 // %%% Data Structures %%%
 /* Structure for electronic warfare target */
@@ -47,6 +48,8 @@ public:
     Sensor* sensor = nullptr;
     // Entity platform
     Platform* entity = nullptr;
+    // Apply one tick of track changes from the selected sensor
+    void applyTrackDeltas(const std::vector<TrackDelta>& deltas);
 
 protected:
     // Handle paint events
@@ -72,6 +75,10 @@ private:
     int ang = 0;
     // List of targets
     QVector<Target> targets;
+    // Displayed tracks, kept current from sensor deltas
+    QHash<Platform*, Target> tracks;
+    // Subscription to the selected sensor
+    QMetaObject::Connection trackConnection;
     // Entity ID
     QString id = "";
     // Hierarchy instance
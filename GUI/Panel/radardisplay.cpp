@@ -71,9 +71,14 @@ void RadarDisplay::selectEntity(Entity* entit)
     id = QString::fromStdString(platform->ID);
     entity = platform;
     // Select first valid sensor
+    disconnect(trackConnection);
+    tracks.clear();
     for (Sensor* s : entity->sensorList) {
         if (s) {
             sensor = s;
+            // Seed from the current table once, then follow the deltas
+            for (const Target &target : sensor->targets) tracks.insert(target.entity, target);
+            trackConnection = connect(sensor, &Sensor::tracksChanged, this, &RadarDisplay::applyTrackDeltas);
             // Set window title with platform name
             setWindowTitle("Radar Display (" + QString::fromStdString(entity->Name) + ")");
             qDebug() << "csdvfyjkygj";
@@ -87,6 +92,8 @@ void RadarDisplay::RemoveEntity(QString ID)
 {
     if (id == ID) {
         // Clear entity and sensor
+        disconnect(trackConnection);
+        tracks.clear();
         entity = nullptr;
         sensor = nullptr;
         // Reset window title
@@ -95,6 +102,26 @@ void RadarDisplay::RemoveEntity(QString ID)
 }
 
 // %%% Update Methods %%%
+/* Apply entered, updated and lost tracks of the radar channel */
+void RadarDisplay::applyTrackDeltas(const std::vector<TrackDelta>& deltas)
+{
+    bool changed = false;
+    for (const TrackDelta &delta : deltas) {
+        if (delta.ew) continue;
+        if (delta.kind == TrackDelta::Lost) {
+            tracks.remove(delta.entity);
+        } else {
+            Target &target = tracks[delta.entity];
+            target.entity = delta.entity;
+            target.angle = delta.angle;
+            target.radius = delta.radius;
+        }
+        changed = true;
+    }
+    // Repaint only when something changed
+    if (changed) update();
+}
+
 /* Update radar display data */
 void RadarDisplay::updateRadar()
 {
@@ -250,7 +277,7 @@ void RadarDisplay::drawTargetAndPath(QPainter &painter, int centerX, int centerY
 {
     if (entity && sensor) {
         painter.setBrush(Qt::red);
-        for (const Target &target : sensor->targets) {
+        for (const Target &target : tracks) {
             int panelhigh = QWidget::height() - 60;
             float per = target.radius / range;
             float radius = panelhigh * per;
@@ -14,6 +14,7 @@
 #include <QJsonObject>                            // For JSON object handling
 #include <QJsonArray>                             // For JSON array handling
 #include <QVector>                                // For vector container
+#include <QHash>                                  // For track table
 
 // %%% Class Definition %%%
 /* Widget for radar display visualization */
@@ -48,6 +49,8 @@ public:
     Sensor* sensor = nullptr;
     // Entity platform
     Platform* entity = nullptr;
+    // Apply one tick of track changes from the selected sensor
+    void applyTrackDeltas(const std::vector<TrackDelta>& deltas);
 
 protected:
     // Handle paint events
@@ -74,6 +77,10 @@ private:
     // };
     // List of targets
     QVector<Target> targets;
+    // Displayed tracks, kept current from sensor deltas
+    QHash<Platform*, Target> tracks;
+    // Subscription to the selected sensor
+    QMetaObject::Connection trackConnection;
     // Entity ID
     QString id = "";
     // Hierarchy instance
@@ -2034,6 +2034,14 @@ void CanvasWidget::handlePaint(QPaintEvent *event) {
     drawEntityInformation(painter);
     drawTransformGizmo(painter);
 
+    // Reported from here since every pan, zoom and resize ends in a repaint
+    const QRectF visibleArea = QRectF(gislib->canvasToGeo(QPointF(0, 0)),
+                                      gislib->canvasToGeo(QPointF(width(), height()))).normalized();
+    if (visibleArea != lastVisibleArea) {
+        lastVisibleArea = visibleArea;
+        emit visibleAreaChanged(visibleArea);
+    }
+
     frameCount++;
 }
 
@@ -65,6 +65,7 @@ public:
     void Render(float deltatime);  // Main rendering function
     void setTransformMode(TransformMode mode);  // Set transformation mode
     void setTrajectoryDrawingMode(bool enabled);  // Enable/disable trajectory drawing
+    QRectF visibleArea() const { return lastVisibleArea; }  // Map extent (lon, lat) at the last paint
     void saveTrajectory();  // Save current trajectory
 
     /* Simulation and editor control section */
@@ -236,6 +237,9 @@ signals:
     void geoJsonLayerAdded(const QString& layerName);  // New GeoJSON layer added
     void pointsUpdated(const QList<QPointF>& points);  // Measurement points updated
 
+    // View signals
+    void visibleAreaChanged(QRectF geoArea);  // Map extent (lon, lat) after a pan, zoom or resize
+
 private:
     // Internal state variables
     bool selectEntity;  // Entity selection flag
@@ -252,6 +256,7 @@ private:
     QPointF canvasOffset = QPointF(0, 0);  // Canvas panning offset
     QPoint lastMousePos;  // Last mouse position for panning
     bool isPanning = false;  // Currently panning canvas
+    QRectF lastVisibleArea;  // Extent last reported by visibleAreaChanged
 
     // Trajectory management
     int findNearestWaypoint(QPointF canvasPos);  // Find nearest waypoint to canvas position
@@ -325,18 +325,37 @@ SOURCES += \
     core/Hierarchy/Struct/vector.cpp \
     core/Hierarchy/Struct/waypoints.cpp \
     core/Hierarchy/Utils/entityutils.cpp \
+    core/Hierarchy/Utils/spatialbenchmark.cpp \
+    core/Hierarchy/Utils/spatialgrid.cpp \
     core/Hierarchy/entity.cpp \
     core/Hierarchy/folder.cpp \
     core/Hierarchy/hierarchy.cpp \
     core/Hierarchy/profilecategaory.cpp \
     core/InputSystem/inputmanager.cpp \
+    core/Network/command.cpp \
+    core/Network/entitystate.cpp \
     core/Network/networkmanager.cpp \
     core/Network/networktransport.cpp \
+    core/Network/serverio.cpp \
+    core/Network/sharedstate.cpp \
+    core/Network/stateinterpolator.cpp \
+    core/Network/worldsync.cpp \
     core/Plugins/pluginmanager.cpp \
     core/Recorder/recorder.cpp \
+    core/Recorder/recordingquery.cpp \
+    core/Recorder/recordingreader.cpp \
+    core/Recorder/recordingstatsreport.cpp \
+    core/Recorder/recordingstream.cpp \
+    core/Recorder/recordingwriter.cpp \
     core/Render/scenerenderer.cpp \
     core/ScriptEngine/scriptengine.cpp \
+    core/Simulation/batchrunner.cpp \
+    core/Simulation/collisionshapecache.cpp \
+    core/Simulation/ensemblerunner.cpp \
+    core/Simulation/jobsystem.cpp \
+    core/Simulation/kinematicstore.cpp \
     core/Simulation/simulation.cpp \
+    core/Simulation/statehashlog.cpp \
     # core/Struct/action.cpp \
     # core/Struct/color.cpp \
     # core/Struct/condition.cpp \
@@ -820,18 +839,39 @@ HEADERS += \
     core/Hierarchy/Struct/vector.h \
     core/Hierarchy/Struct/waypoints.h \
     core/Hierarchy/Utils/entityutils.h \
+    core/Hierarchy/Utils/spatialbenchmark.h \
+    core/Hierarchy/Utils/spatialgrid.h \
     core/Hierarchy/entity.h \
     core/Hierarchy/folder.h \
     core/Hierarchy/hierarchy.h \
     core/Hierarchy/profilecategaory.h \
     core/InputSystem/inputmanager.h \
+    core/Network/command.h \
+    core/Network/entitystate.h \
     core/Network/networkmanager.h \
     core/Network/networktransport.h \
+    core/Network/serverio.h \
+    core/Network/sharedstate.h \
+    core/Network/stateinterpolator.h \
+    core/Network/worldsync.h \
     core/Plugins/pluginmanager.h \
     core/Recorder/recorder.h \
+    core/Recorder/recordingformat.h \
+    core/Recorder/recordingquery.h \
+    core/Recorder/recordingreader.h \
+    core/Recorder/recordingstatsreport.h \
+    core/Recorder/recordingstream.h \
+    core/Recorder/recordingwriter.h \
+    core/Recorder/spscqueue.h \
     core/Render/scenerenderer.h \
     core/ScriptEngine/scriptengine.h \
+    core/Simulation/batchrunner.h \
+    core/Simulation/collisionshapecache.h \
+    core/Simulation/ensemblerunner.h \
+    core/Simulation/jobsystem.h \
+    core/Simulation/kinematicstore.h \
     core/Simulation/simulation.h \
+    core/Simulation/statehashlog.h \
     core/Utility/uuid.h \
     core/structure/database.h \
     core/structure/entity.h \
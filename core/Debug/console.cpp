@@ -5,8 +5,19 @@
 #include <QJsonObject>
 #include <QDebug>
 #include <QDateTime>
+#include <mutex>
+
+// Simulation jobs may log from worker threads
+static std::mutex logMutex;
+
+static void appendLog(std::pair<std::string, std::string> entry) {
+    std::lock_guard<std::mutex> lock(logMutex);
+    Console::internalInstance()->logList->insert(std::move(entry));
+}
 
 Console::Console() {
+    // Updates emitted from worker threads reach the editors as queued calls
+    qRegisterMetaType<std::string>("std::string");
     logList = new std::unordered_map<std::string, std::string>();
 }
 
@@ -18,7 +29,7 @@ Console* Console::internalInstance()
 
 void Console::log(std::string log) {
     std::cout << "Log: " << log << std::endl;
-    internalInstance()->logList->insert({"log", log});
+    appendLog({"log", log});
     emit internalInstance()->logUpdate(log);
 }
 
@@ -27,19 +38,19 @@ void Console::log(QJsonObject obj) {
     QString jsonString = doc.toJson(QJsonDocument::Indented);
     std::string log = jsonString.toStdString();
     std::cout << "Log: " << log << std::endl;
-    internalInstance()->logList->insert({"log", log});
+    appendLog({"log", log});
     emit internalInstance()->logUpdate(log);
 }
 
 void Console::error(std::string msg) {
     std::cerr << "Error: " << msg << std::endl;
-    internalInstance()->logList->insert({"error", msg});
+    appendLog({"error", msg});
     emit internalInstance()->errorUpdate(msg);
 }
 
 void Console::warning(std::string warning) {
     std::clog << "Warning: " << warning << std::endl;
-    internalInstance()->logList->insert({"warning", warning});
+    appendLog({"warning", warning});
     emit internalInstance()->warningUpdate(warning);
 }
 
@@ -2,7 +2,9 @@
 
 #ifndef CONSOLE_H
 #define CONSOLE_H
+#include <QMetaType>
 #include <QObject>
+#include <string>
 #include <unordered_map>
 
 class Console: public QObject
@@ -31,4 +33,6 @@ private:
     Console();
 };
 
+Q_DECLARE_METATYPE(std::string)
+
 #endif // CONSOLE_H
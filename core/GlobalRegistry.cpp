@@ -1,6 +1,14 @@
 #include "GlobalRegistry.h"
+#include "core/Hierarchy/entity.h"
 
 // Yeh line zaroori hai linker ke liye
-std::unordered_map<ProfileCategaory*, Hierarchy*> GlobalRegistry::profileToHierarchyMap;
-std::unordered_map<Folder*, Hierarchy*> GlobalRegistry::folderToHierarchyMap;
-std::unordered_map<Entity*, Hierarchy*> GlobalRegistry::entityToHierarchyMap;
+thread_local std::unordered_map<ProfileCategaory*, Hierarchy*> GlobalRegistry::profileToHierarchyMap;
+thread_local std::unordered_map<Folder*, Hierarchy*> GlobalRegistry::folderToHierarchyMap;
+
+void GlobalRegistry::registerEntity(Entity* entity, Hierarchy* hierarchy) {
+    entity->parentHierarchy = hierarchy;
+}
+
+Hierarchy* GlobalRegistry::getParentHierarchy(Entity* entity) {
+    return entity ? entity->parentHierarchy : nullptr;
+}
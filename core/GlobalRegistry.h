@@ -9,11 +9,13 @@ class ProfileCategaory;
 class Folder;
 class Entity;
 
+// The maps are per thread so that hierarchies built on different threads
+// (ensemble replicas) never see each other. Entities keep their owner on the
+// object itself, so their lookup also works from simulation worker threads.
 class GlobalRegistry {
 public:
-    static std::unordered_map<ProfileCategaory*, Hierarchy*> profileToHierarchyMap;
-    static std::unordered_map<Folder*, Hierarchy*> folderToHierarchyMap;
-    static std::unordered_map<Entity*, Hierarchy*> entityToHierarchyMap;
+    static thread_local std::unordered_map<ProfileCategaory*, Hierarchy*> profileToHierarchyMap;
+    static thread_local std::unordered_map<Folder*, Hierarchy*> folderToHierarchyMap;
 
     static void registerProfile(ProfileCategaory* profile, Hierarchy* hierarchy) {
         profileToHierarchyMap[profile] = hierarchy;
@@ -39,16 +41,8 @@ public:
     }
 
     ///////////////////////
-    static void registerEntity(Entity* entity, Hierarchy* hierarchy) {
-        entityToHierarchyMap[entity] = hierarchy;
-    }
-
-    static Hierarchy* getParentHierarchy(Entity* entity) {
-        if (entityToHierarchyMap.count(entity)) {
-            return entityToHierarchyMap[entity];
-        }
-        return nullptr;
-    }
+    static void registerEntity(Entity* entity, Hierarchy* hierarchy);
+    static Hierarchy* getParentHierarchy(Entity* entity);
 };
 
 #endif // GLOBALREGISTRY_H
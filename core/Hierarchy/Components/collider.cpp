@@ -94,5 +94,6 @@ void Collider::fromJson(const QJsonObject& obj) {
             customParameters[it.key()] = it.value();
         }
     }
+    markChanged();
     //Console::log("Collider::fromJson customParameters: " + QString(QJsonDocument(customParameters).toJson()).toStdString());
 }
@@ -23,6 +23,10 @@ public:
     ~Component();
     virtual ComponentType Typo() const { return ComponentType::Unknown; }
 
+    // Bumped whenever a property mirrored into the physics world changes
+    quint64 revision = 0;
+    void markChanged() { ++revision; }
+
     // 🔧 Add these two pure virtual functions
     virtual QJsonObject toJson() const = 0;
     virtual void fromJson(const QJsonObject& obj) = 0;
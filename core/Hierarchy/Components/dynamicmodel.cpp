@@ -171,7 +171,7 @@ void DynamicModel::FollowTrajectory() {
         // return; // Skip trajectory logic
     }
     if(trajectory->Trajectories.size()<2) return;
-    QVector3D current = transform->matrix->translation();
+    QVector3D current = transform->translation();
     Vector target = *trajectory->Trajectories[trajectory->current]->position;
     QVector3D target_qvec(target.x, target.y, target.z);
     QVector3D diff = target_qvec - current;
@@ -200,7 +200,7 @@ void DynamicModel::FollowTrajectory() {
     transform->setTranslation(current);
     //*transform->position = Vector::Lerp(*transform->position, *trajectory->Trajectories[trajectory->current]->position, moveSpeed * 0.1);
 
-    if (trajectory->Trajectories.size() > trajectory->current && (transform->matrix->translation()).distanceToPoint(QVector3D(
+    if (trajectory->Trajectories.size() > trajectory->current && (transform->translation()).distanceToPoint(QVector3D(
                                                                      trajectory->Trajectories[trajectory->current]->position->x,
                                                                      trajectory->Trajectories[trajectory->current]->position->y,
                                                                      trajectory->Trajectories[trajectory->current]->position->z
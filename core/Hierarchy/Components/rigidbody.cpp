@@ -141,5 +141,7 @@ void Rigidbody::fromJson(const QJsonObject& obj) {
         }
     }
 
+    markChanged();
+
     //qDebug() << "Rigidbody::fromJson customParameters:" << QJsonDocument(customParameters).toJson(QJsonDocument::Compact);
 }
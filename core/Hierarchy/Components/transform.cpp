@@ -2,6 +2,7 @@
 #include "core/Hierarchy/Struct/geocords.h"
 #include "qjsonarray.h"
 #include <core/Utility/uuid.h>
+#include <core/Simulation/kinematicstore.h>
 #include <cmath>
 #include <QVector3D>
 #include <QQuaternion>
@@ -16,30 +17,48 @@ Transform::Transform() {
 
     customParameters = QJsonObject();
     setTranslation(QVector3D(28.7041,0,77.1025));
+
+    // Edits made directly on the view (canvas drag, 3D view) flow back into the store
+    connect(matrix, &Qt3DCore::QTransform::translationChanged, this, [this](const QVector3D& v) {
+        if (kinematicStore && !kinematicStore->isSyncing()) kinematicStore->positions[kinematicSlot] = v;
+    });
+    connect(matrix, &Qt3DCore::QTransform::rotationChanged, this, [this](const QQuaternion& q) {
+        if (kinematicStore && !kinematicStore->isSyncing()) kinematicStore->orientations[kinematicSlot] = q;
+    });
+    connect(matrix, &Qt3DCore::QTransform::scale3DChanged, this, [this](const QVector3D& v) {
+        if (kinematicStore && !kinematicStore->isSyncing()) {
+            kinematicStore->scales[kinematicSlot] = v;
+            markChanged();
+        }
+    });
+}
+
+Transform::~Transform() {
+    if (kinematicStore) kinematicStore->detach(this);
 }
 
 // ===== Unity-like Directional Methods (using QQuaternion) =====
 QVector3D Transform::toEulerAngles() const {
-    return matrix->rotation().toEulerAngles();
+    return rotation().toEulerAngles();
 }
 
 void Transform::setFromEulerAngles(const QVector3D& eulerAngles) {
-    matrix->setRotation(QQuaternion::fromEulerAngles(eulerAngles));
+    setRotation(QQuaternion::fromEulerAngles(eulerAngles));
 }
 
 // Unity में forward direction Z-axis होता है।
 QVector3D Transform::forward() {
-    return matrix->rotation().rotatedVector(QVector3D(0.0f, 0.0f, 1.0f));
+    return rotation().rotatedVector(QVector3D(0.0f, 0.0f, 1.0f));
 }
 
 QVector3D Transform::up() {
     // Rotation को up vector (Y-axis) पर लागू करें।
-    return matrix->rotation().rotatedVector(QVector3D(0.0f, 1.0f, 0.0f));
+    return rotation().rotatedVector(QVector3D(0.0f, 1.0f, 0.0f));
 }
 
 QVector3D Transform::right() {
     // Rotation को right vector (X-axis) पर लागू करें।
-    return matrix->rotation().rotatedVector(QVector3D(1.0f, 0.0f, 0.0f));
+    return rotation().rotatedVector(QVector3D(1.0f, 0.0f, 0.0f));
 }
 
 QVector3D Transform::back() {
@@ -55,11 +74,11 @@ QVector3D Transform::down() {
 }
 
 QVector3D Transform::inverseTransformDirection(const QVector3D& worldDir) {
-    return matrix->rotation().inverted().rotatedVector(worldDir);
+    return rotation().inverted().rotatedVector(worldDir);
 }
 
 QVector3D Transform::TransformDirection(const QVector3D& localDir) {
-    return matrix->rotation().rotatedVector(localDir);
+    return rotation().rotatedVector(localDir);
 }
 
 /**
@@ -69,7 +88,7 @@ QVector3D Transform::TransformDirection(const QVector3D& localDir) {
  */
 QVector3D Transform::inverseTransformVector(const QVector3D& worldVec) {
     // Vectors (like velocity or force) are only affected by rotation, not position/translation.
-    return matrix->rotation().inverted().rotatedVector(worldVec);
+    return rotation().inverted().rotatedVector(worldVec);
 }
 
 /**
@@ -78,40 +97,56 @@ QVector3D Transform::inverseTransformVector(const QVector3D& worldVec) {
  */
 QVector3D Transform::inverseTransformPoint(const QVector3D& worldPos) {
     // 1. First, apply the inverse of translation (subtract the world position).
-    QVector3D relativePosition = worldPos - matrix->translation();
+    QVector3D relativePosition = worldPos - translation();
 
     // 2. Then, apply the inverse of rotation.
-    return matrix->rotation().inverted().rotatedVector(relativePosition);
+    return rotation().inverted().rotatedVector(relativePosition);
 }
 
 // ===== Other Methods =====
 
 void Transform::setTranslation(const QVector3D& vector) {
+    if (kinematicStore) {
+        kinematicStore->positions[kinematicSlot] = vector;
+        if (kinematicStore->deferViews()) return;
+    }
     matrix->setTranslation(vector);
 }
 
 void Transform::addTranslation(const QVector3D& vector) {
-    matrix->setTranslation(translation()+vector);
+    setTranslation(translation()+vector);
 }
 
-QVector3D Transform::translation() {
+QVector3D Transform::translation() const {
+    if (kinematicStore) return kinematicStore->positions[kinematicSlot];
     return matrix->translation();
 }
 
 void Transform::setRotation(const QQuaternion& quat) {
+    if (kinematicStore) {
+        kinematicStore->orientations[kinematicSlot] = quat;
+        if (kinematicStore->deferViews()) return;
+    }
     matrix->setRotation(quat);
 }
 
-QQuaternion Transform::rotation() {
+QQuaternion Transform::rotation() const {
+    if (kinematicStore) return kinematicStore->orientations[kinematicSlot];
     return matrix->rotation();
 }
 
 void Transform::setScale3D(const QVector3D& vector) {
+    markChanged();
+    if (kinematicStore) {
+        kinematicStore->scales[kinematicSlot] = vector;
+        if (kinematicStore->deferViews()) return;
+    }
     matrix->setScale3D(vector);
 }
 
 
-QVector3D Transform::scale3D() {
+QVector3D Transform::scale3D() const {
+    if (kinematicStore) return kinematicStore->scales[kinematicSlot];
     return matrix->scale3D();
 }
 
@@ -120,10 +155,12 @@ QJsonObject Transform::toJson() const {
     obj["id"] = QString::fromStdString(ID);
     obj["active"] = Active;
     obj["geocord"] = geocord->toJson();
-    obj["position"] = (new Vector(matrix->translation().x(),matrix->translation().y(),matrix->translation().z()))->toJson();
+    QVector3D pos = translation();
+    obj["position"] = (new Vector(pos.x(),pos.y(),pos.z()))->toJson();
     QVector3D rot = toEulerAngles();
     obj["rotation"] = (new Vector(rot.x(),rot.y(),rot.z()))->toJson();
-    obj["size"] = (new Vector(matrix->scale3D().x(),matrix->scale3D().y(),matrix->scale3D().z()))->toJson();
+    QVector3D size = scale3D();
+    obj["size"] = (new Vector(size.x(),size.y(),size.z()))->toJson();
     // obj["localPosition"] = (new Vector(localPosition->x(),localPosition->y(),localPosition->z()))->toJson();
     // QVector3D localrot = toEulerAngles();
     // obj["localRotation"] = (new Vector(localrot.x(),localrot.y(),localrot.z()))->toJson();
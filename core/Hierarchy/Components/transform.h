@@ -10,11 +10,13 @@
 #include <QMatrix4x4>
 #include <QVariant>
 #include <Qt3DCore/QTransform>
+class KinematicStore;
 class Transform : public QObject, public Component
 {
     Q_OBJECT
 public:
     Transform();
+    ~Transform();
     ComponentType Typo() const override { return ComponentType::Transform; }
     bool Active;
     std::string ID;
@@ -23,6 +25,11 @@ public:
     Qt3DCore::QTransform* matrix;
     // Use QVector3D and QQuaternion directly
 
+    // Set while the simulation owns this transform's state (see KinematicStore);
+    // matrix is then a view that may lag until the next sync.
+    KinematicStore* kinematicStore = nullptr;
+    int kinematicSlot = -1;
+
     QVector3D toEulerAngles() const;
     void setFromEulerAngles(const QVector3D& eulerAngles);
 
@@ -31,11 +38,11 @@ public:
 
     void setTranslation(const QVector3D& vector);
     void addTranslation(const QVector3D& vector);
-    QVector3D translation();
+    QVector3D translation() const;
     void setRotation(const QQuaternion& quat);
-    QQuaternion rotation();
+    QQuaternion rotation() const;
     void setScale3D(const QVector3D& vector);
-    QVector3D scale3D();
+    QVector3D scale3D() const;
 
     // Directional methods using Quaternion math
     QVector3D forward();
@@ -6,6 +6,8 @@
 #include <QVector3D>   // For QVector3D
 #include <vector>      // For targets (assuming std::vector)
 #include <unordered_set> // For detects (for fast Contains/Add/Remove)
+#include <algorithm>
+#include <core/Hierarchy/EntityProfiles/platform.h>
 
 // M_PI को अधिकांश सिस्टम में डिफाइन किया जाता है, लेकिन इसकी गारंटी नहीं है।
 // इसलिए, आप इसे मैन्युअल रूप से डिफाइन कर सकते हैं:
@@ -50,130 +52,153 @@ void Sensor::updateComponent(QString name, const QJsonObject& /*obj*/) {
     Console::error(name.toStdString() + ": Sensor does not support components");
 }
 
-void Sensor::scan(std::string id , Transform *source)
+// Candidate platforms near the source: from the per-tick spatial index when the
+// simulation has built one, otherwise every platform in the hierarchy.
+void Sensor::collectCandidates(const std::string& id, Transform *source, float radius, std::vector<Platform*>& out)
 {
     Hierarchy* parent = GlobalRegistry::getParentHierarchy(this);
-    // C# foreach (Transform tr in targets) -> C++ range-based for loop
-    for (auto& [key, entity] : *parent->Entities)
+    if (!parent) return;
+
+    if (parent->spatialIndex.isBuilt()) {
+        parent->spatialIndex.query(source->translation(), radius, out);
+    } else {
+        for (auto& [key, entity] : *parent->Entities) {
+            Platform* platform = dynamic_cast<Platform*>(entity);
+            if (platform) out.push_back(platform);
+        }
+    }
+    out.erase(std::remove_if(out.begin(), out.end(), [&id](Platform* p) {
+        return !p->transform || p->ID == id;
+    }), out.end());
+}
+
+void Sensor::updateTrack(Platform* platform, bool inRange, float angle, float distance, bool ew,
+                         std::unordered_map<Platform*, TrackEntry>& tracked, QVector<Target>& list)
+{
+    auto it = tracked.find(platform);
+    if (inRange)
     {
-        if(key == id) continue;
-        Platform* platform = dynamic_cast<Platform*>(entity);
-        if (platform) {
-            //qDebug()<< "platform";
-            QVector3D localPos = source->inverseTransformPoint(platform->transform->matrix->translation());
-            float distance = localPos.length();
-            // horizontal angle (Y axis) : x vs z
-            float yAngle = std::atan2(localPos.x(), localPos.z()) * RAD2DEG;
-            // InverseTransformPoint(tr.position) (Transform method assumed to exist)
-            if (detectCheck(localPos)) // .position() is assumed
-            {
-                //qDebug()<< "detect";
-                // C# !detects.Contains(tr) -> C++ detects.count(tr) == 0
-                if (detects.count(platform) == 0)
-                {
-                    // C# detects.Add(tr) -> C++ detects.insert(tr)
-                    detects.insert(platform);
-                    Target target;
-                    target.entity = platform;
-                    target.angle = yAngle;
-                    target.radius = distance;
-                    targets.append(target);
-                    //qDebug()<< "detect :"<<&entity->Name;
-                }else{
-                    for (int i = 0; i < targets.size(); ++i) {
-                        if (targets.at(i).entity == platform) {
-                            targets[i].angle = yAngle;
-                            targets[i].radius = distance;
-                            //qDebug()<< localPos;
-                            break; // एक बार मिल जाने पर लूप से बाहर निकल जाएँ
-                        }
-                    }
-                    //qDebug()<< "detect :"<< QString::fromStdString(entity->Name);
-                }
-            }
-            else
-            {
-                // C# detects.Contains(tr) -> C++ detects.count(tr) > 0
-                if (detects.count(platform) > 0)
-                {
-                    // C# detects.Remove(tr) -> C++ detects.erase(tr)
-                    // 1. target को खोजने के लिए iterate करें
-                    for (int i = 0; i < targets.size(); ++i) {
-                        if (targets.at(i).entity == platform) {
-                            // 2. मिल जाने पर, उसे index द्वारा हटा दें
-                            targets.removeAt(i);
-                            break; // एक बार मिल जाने पर लूप से बाहर निकल जाएँ
-                        }
-                    }
-                    detects.erase(platform);
-                    qDebug()<< "vanish :"<<&entity->Name;
-                }
+        if (it == tracked.end())
+        {
+            tracked[platform] = TrackEntry{list.size(), platform->ID};
+            Target target{};
+            target.entity = platform;
+            target.angle = angle;
+            target.radius = distance;
+            list.append(target);
+            trackDeltas.push_back({TrackDelta::Entered, ew, platform, platform->ID, angle, distance});
+        }else{
+            Target& target = list[it->second.index];
+            if (target.angle != angle || target.radius != distance) {
+                target.angle = angle;
+                target.radius = distance;
+                trackDeltas.push_back({TrackDelta::Updated, ew, platform, it->second.id, angle, distance});
             }
         }
     }
+    else if (it != tracked.end())
+    {
+        qDebug()<< "vanish :"<<QString::fromStdString(platform->Name);
+        removeTrack(platform, ew, tracked, list);
+    }
 }
 
-void Sensor::ewscan(std::string id , Transform *source)
+// Swap-remove: the last target takes the freed slot
+void Sensor::removeTrack(Platform* platform, bool ew,
+                         std::unordered_map<Platform*, TrackEntry>& tracked, QVector<Target>& list)
+{
+    auto it = tracked.find(platform);
+    const int index = it->second.index;
+    const int last = list.size() - 1;
+    const Target lost = list.at(index);
+    trackDeltas.push_back({TrackDelta::Lost, ew, platform, it->second.id, lost.angle, lost.radius});
+    tracked.erase(it);
+    if (index != last) {
+        list[index] = list.at(last);
+        tracked[list.at(index).entity].index = index;
+    }
+    list.removeLast();
+}
+
+// Tracks that were not among this scan's candidates left the queried cells
+// (or the hierarchy) and are out of range by construction.
+void Sensor::dropUnseen(const std::unordered_set<Platform*>& seen, bool ew,
+                        std::unordered_map<Platform*, TrackEntry>& tracked, QVector<Target>& list)
+{
+    if (tracked.size() == seen.size()) return;
+    // Backwards, so a target swapped into slot i has already been checked
+    for (int i = list.size() - 1; i >= 0; --i) {
+        if (seen.count(list.at(i).entity) == 0) removeTrack(list.at(i).entity, ew, tracked, list);
+    }
+}
+
+void Sensor::publishDeltas()
+{
+    if (trackDeltas.empty()) return;
+    emit tracksChanged(trackDeltas);
+    trackDeltas.clear();
+}
+
+// A lost target may already be gone from this hierarchy, so lost tracks are
+// matched by the ID kept in the table
+void Sensor::applyRemoteDeltas(const std::vector<TrackDelta>& deltas)
 {
     Hierarchy* parent = GlobalRegistry::getParentHierarchy(this);
-    // C# foreach (Transform tr in targets) -> C++ range-based for loop
-    for (auto& [key, entity] : *parent->Entities)
-    {
-        if(key == id) continue;
-        Platform* platform = dynamic_cast<Platform*>(entity);
-        if (platform) {
-            //qDebug()<< "platform";
-            QVector3D localPos = source->inverseTransformPoint(platform->transform->matrix->translation());
-            float distance = localPos.length();
-            // horizontal angle (Y axis) : x vs z
-            float yAngle = std::atan2(localPos.x(), localPos.z()) * RAD2DEG;
-            // InverseTransformPoint(tr.position) (Transform method assumed to exist)
-            if (distance<ewrange) // .position() is assumed
-            {
-                //qDebug()<< "detect";
-                // C# !detects.Contains(tr) -> C++ detects.count(tr) == 0
-                if (ewdetects.count(platform) == 0)
-                {
-                    // C# detects.Add(tr) -> C++ detects.insert(tr)
-                    ewdetects.insert(platform);
-                    Target target;
-                    target.entity = platform;
-                    target.angle = yAngle;
-                    target.radius = distance;
-                    ewtargets.append(target);
-                    //qDebug()<< "detect :"<<&entity->Name;
-                }else{
-                    for (int i = 0; i < ewtargets.size(); ++i) {
-                        if (ewtargets.at(i).entity == platform) {
-                            ewtargets[i].angle = yAngle;
-                            ewtargets[i].radius = distance;
-                            //qDebug()<< localPos;
-                            break; // एक बार मिल जाने पर लूप से बाहर निकल जाएँ
-                        }
-                    }
-                    //qDebug()<< "detect :"<< QString::fromStdString(entity->Name);
-                }
-            }
-            else
-            {
-                // C# detects.Contains(tr) -> C++ detects.count(tr) > 0
-                if (ewdetects.count(platform) > 0)
-                {
-                    // C# detects.Remove(tr) -> C++ detects.erase(tr)
-                    // 1. target को खोजने के लिए iterate करें
-                    for (int i = 0; i < ewtargets.size(); ++i) {
-                        if (ewtargets.at(i).entity == platform) {
-                            // 2. मिल जाने पर, उसे index द्वारा हटा दें
-                            ewtargets.removeAt(i);
-                            break; // एक बार मिल जाने पर लूप से बाहर निकल जाएँ
-                        }
-                    }
-                    ewdetects.erase(platform);
-                    qDebug()<< "vanish :"<<&entity->Name;
-                }
-            }
+    if (!parent) return;
+
+    for (const TrackDelta& delta : deltas) {
+        auto& tracked = delta.ew ? ewdetects : detects;
+        QVector<Target>& list = delta.ew ? ewtargets : targets;
+        if (delta.kind == TrackDelta::Lost) {
+            auto it = std::find_if(tracked.begin(), tracked.end(), [&delta](const auto& entry) {
+                return entry.second.id == delta.targetId;
+            });
+            if (it != tracked.end()) removeTrack(it->first, delta.ew, tracked, list);
+            continue;
         }
+        auto found = parent->Entities->find(delta.targetId);
+        Platform* platform = found != parent->Entities->end() ? dynamic_cast<Platform*>(found->second) : nullptr;
+        if (platform) updateTrack(platform, true, delta.angle, delta.radius, delta.ew, tracked, list);
+    }
+    publishDeltas();
+}
+
+void Sensor::scan(std::string id , Transform *source)
+{
+    std::vector<Platform*> candidates;
+    collectCandidates(id, source, range, candidates);
+
+    std::unordered_set<Platform*> seen;
+    for (Platform* platform : candidates)
+    {
+        QVector3D localPos = source->inverseTransformPoint(platform->transform->translation());
+        float distance = localPos.length();
+        // horizontal angle (Y axis) : x vs z
+        float yAngle = std::atan2(localPos.x(), localPos.z()) * RAD2DEG;
+        bool inRange = detectCheck(localPos);
+        updateTrack(platform, inRange, yAngle, distance, false, detects, targets);
+        if (inRange) seen.insert(platform);
+    }
+    dropUnseen(seen, false, detects, targets);
+}
+
+void Sensor::ewscan(std::string id , Transform *source)
+{
+    std::vector<Platform*> candidates;
+    collectCandidates(id, source, ewrange, candidates);
+
+    std::unordered_set<Platform*> seen;
+    for (Platform* platform : candidates)
+    {
+        QVector3D localPos = source->inverseTransformPoint(platform->transform->translation());
+        float distance = localPos.length();
+        // horizontal angle (Y axis) : x vs z
+        float yAngle = std::atan2(localPos.x(), localPos.z()) * RAD2DEG;
+        bool inRange = distance < ewrange;
+        updateTrack(platform, inRange, yAngle, distance, true, ewdetects, ewtargets);
+        if (inRange) seen.insert(platform);
     }
+    dropUnseen(seen, true, ewdetects, ewtargets);
 }
 
 
@@ -9,6 +9,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -23,6 +24,18 @@ struct Target{
     float lon;
 };
 
+// One change to a sensor's track table during a tick. Platform pointers are
+// identity only: a lost target may already have been deleted.
+struct TrackDelta {
+    enum Kind : quint8 { Entered, Updated, Lost };
+    Kind kind;
+    bool ew;               // ewscan channel rather than scan
+    Platform* entity;
+    std::string targetId;
+    float angle;
+    float radius;
+};
+
 class Sensor : public Entity
 {
     Q_OBJECT
@@ -68,11 +81,24 @@ public:
     float noiseFigure = 0.0f; // dB
     bool clutterRejection = false;
     bool eccmCapability = false;
+    // Track tables: targets is dense, detects maps each tracked platform to
+    // its slot so updates and removals are O(1)
+    struct TrackEntry {
+        int index;
+        std::string id;
+    };
     std::vector<Detection> detections;
-    std::unordered_set<Platform*> detects;
+    std::unordered_map<Platform*, TrackEntry> detects;
     QVector<Target> targets;
-    std::unordered_set<Platform*> ewdetects;
+    std::unordered_map<Platform*, TrackEntry> ewdetects;
     QVector<Target> ewtargets;
+
+    // Changes made by this tick's scans, published and cleared by the simulation
+    std::vector<TrackDelta> trackDeltas;
+    void publishDeltas();
+    // Client side: applies the server's deltas (entity pointers unused,
+    // targets resolved by ID) and publishes them like a local scan
+    void applyRemoteDeltas(const std::vector<TrackDelta>& deltas);
     void scan(std::string id, Transform *source);
     void ewscan(std::string id , Transform *source);
     bool detectCheck(QVector3D localPos);
@@ -87,7 +113,18 @@ public:
     QJsonObject toJson() const override;
     void fromJson(const QJsonObject& obj) override;
 
+signals:
+    void tracksChanged(const std::vector<TrackDelta>& deltas);
+
 private:
+    void collectCandidates(const std::string& id, Transform* source, float radius, std::vector<Platform*>& out);
+    void updateTrack(Platform* platform, bool inRange, float angle, float distance, bool ew,
+                     std::unordered_map<Platform*, TrackEntry>& tracked, QVector<Target>& list);
+    void removeTrack(Platform* platform, bool ew,
+                     std::unordered_map<Platform*, TrackEntry>& tracked, QVector<Target>& list);
+    void dropUnseen(const std::unordered_set<Platform*>& seen, bool ew,
+                    std::unordered_map<Platform*, TrackEntry>& tracked, QVector<Target>& list);
+
     QString modeToString(Mode m) const;
     Mode stringToMode(const QString& str) const;
 };
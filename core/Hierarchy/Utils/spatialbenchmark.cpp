@@ -0,0 +1,105 @@
+#include "spatialbenchmark.h"
+#include "core/Hierarchy/hierarchy.h"
+#include "core/Hierarchy/EntityProfiles/platform.h"
+#include "core/Hierarchy/EntityProfiles/sensor.h"
+#include <core/Debug/console.h>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+
+// Every platform carries one sensor (range 100) in a world whose area grows
+// with N, so each sensor sees roughly a dozen neighbours at any size. A sample
+// of platforms is updated with and without the index; the per-platform cost
+// times N is the projected sensor cost of one tick.
+void SpatialBenchmark::run(int entityCount) {
+    std::unique_ptr<Hierarchy> h(new Hierarchy());
+    std::mt19937 rng(12345);
+    const float extent = 50.0f * std::sqrt(static_cast<float>(entityCount));
+    std::uniform_real_distribution<float> horizontal(0.0f, extent);
+    std::uniform_real_distribution<float> vertical(0.0f, 100.0f);
+    std::uniform_real_distribution<float> heading(0.0f, 360.0f);
+
+    std::vector<Platform*> platforms;
+    platforms.reserve(entityCount);
+    for (int i = 0; i < entityCount; ++i) {
+        Platform* platform = new Platform(h.get());
+        platform->Name = "bench" + std::to_string(i);
+        platform->transform = new Transform();
+        platform->transform->setTranslation(QVector3D(horizontal(rng), vertical(rng), horizontal(rng)));
+        platform->transform->setFromEulerAngles(QVector3D(0, heading(rng), 0));
+        Sensor* sensor = new Sensor(h.get());
+        sensor->range = 100.0f;
+        sensor->ewrange = 100.0f;
+        platform->addSensor(sensor);
+        (*h->Entities)[platform->ID] = platform;
+        platforms.push_back(platform);
+    }
+
+    const int samples = std::min(entityCount, 500);
+    auto resetTracks = [&]() {
+        for (int i = 0; i < samples; ++i) {
+            Sensor* s = platforms[i]->sensorList.front();
+            s->detects.clear();
+            s->targets.clear();
+            s->ewdetects.clear();
+            s->ewtargets.clear();
+        }
+    };
+    auto countTracks = [&]() {
+        qint64 n = 0;
+        for (int i = 0; i < samples; ++i) {
+            Sensor* s = platforms[i]->sensorList.front();
+            n += s->targets.size() + s->ewtargets.size();
+        }
+        return n;
+    };
+
+    QElapsedTimer timer;
+
+    h->spatialIndex.invalidate();
+    timer.start();
+    for (int i = 0; i < samples; ++i) platforms[i]->update();
+    const double fullPerPlatform = timer.nsecsElapsed() / 1e3 / samples;
+    const qint64 fullTracks = countTracks();
+
+    resetTracks();
+    timer.restart();
+    h->rebuildSpatialIndex();
+    const double buildMs = timer.nsecsElapsed() / 1e6;
+    timer.restart();
+    for (int i = 0; i < samples; ++i) platforms[i]->update();
+    const double gridPerPlatform = timer.nsecsElapsed() / 1e3 / samples;
+    const qint64 gridTracks = countTracks();
+    h->spatialIndex.clear();
+
+    Console::log("bench-spatial N=" + std::to_string(entityCount) +
+                 ": full scan " + std::to_string(fullPerPlatform) + " us/platform, grid " +
+                 std::to_string(gridPerPlatform) + " us/platform (build " + std::to_string(buildMs) +
+                 " ms), projected tick " + std::to_string(fullPerPlatform * entityCount / 1e3) + " ms vs " +
+                 std::to_string(gridPerPlatform * entityCount / 1e3 + buildMs) + " ms, tracks " +
+                 std::to_string(fullTracks) + "/" + std::to_string(gridTracks) +
+                 (fullTracks == gridTracks ? "" : " MISMATCH"));
+
+    // The Hierarchy deletes the platforms; their sensors and transforms are ours
+    for (Platform* platform : platforms) {
+        for (Sensor* s : platform->sensorList) delete s;
+        delete platform->transform;
+    }
+}
+
+int SpatialBenchmark::exec(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("TDF spatial index benchmark");
+    parser.addHelpOption();
+    QCommandLineOption countsOption("bench-spatial", "Comma separated entity counts, e.g. 1000,10000,50000.", "counts");
+    parser.addOption(countsOption);
+    parser.process(arguments);
+
+    for (const QString& count : parser.value(countsOption).split(',', Qt::SkipEmptyParts)) {
+        if (count.toInt() > 0) run(count.toInt());
+    }
+    return 0;
+}
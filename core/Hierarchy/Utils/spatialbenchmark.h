@@ -0,0 +1,15 @@
+#ifndef SPATIALBENCHMARK_H
+#define SPATIALBENCHMARK_H
+
+#include <QStringList>
+
+// Full-scan vs spatial-index sensor sweep over a synthetic world, reached
+// through "--bench-spatial 1000,10000,50000" on the headless entry point.
+class SpatialBenchmark
+{
+public:
+    static void run(int entityCount);
+    static int exec(const QStringList& arguments);
+};
+
+#endif // SPATIALBENCHMARK_H
@@ -0,0 +1,86 @@
+#include "spatialgrid.h"
+#include <algorithm>
+#include <cmath>
+
+// 21 bits per axis in the packed cell key
+static const int GRID_COORD_LIMIT = (1 << 20) - 1;
+
+SpatialGrid::SpatialGrid(float cellSize) {
+    m_cellSize = std::max(cellSize, 1.0f);
+}
+
+// Empties every cell but keeps its storage for the next rebuild. Cells that
+// were already empty, i.e. held nothing during the last build, are released.
+void SpatialGrid::clear() {
+    for (auto it = m_cells.begin(); it != m_cells.end();) {
+        if (it->second.platforms.empty()) {
+            it = m_cells.erase(it);
+        } else {
+            it->second.platforms.clear();
+            ++it;
+        }
+    }
+    m_count = 0;
+    m_built = false;
+}
+
+void SpatialGrid::setCellSize(float size) {
+    size = std::max(size, 1.0f);
+    if (size == m_cellSize) return;
+    m_cellSize = size;
+    m_cells.clear();
+    m_count = 0;
+    m_built = false;
+}
+
+void SpatialGrid::insert(Platform* platform, const QVector3D& position) {
+    const int x = cellCoord(position.x());
+    const int y = cellCoord(position.y());
+    const int z = cellCoord(position.z());
+    Cell& cell = m_cells[key(x, y, z)];
+    cell.x = x;
+    cell.y = y;
+    cell.z = z;
+    cell.platforms.push_back(platform);
+    m_count++;
+    m_built = true;
+}
+
+void SpatialGrid::query(const QVector3D& center, float radius, std::vector<Platform*>& out) const {
+    const int x0 = cellCoord(center.x() - radius), x1 = cellCoord(center.x() + radius);
+    const int y0 = cellCoord(center.y() - radius), y1 = cellCoord(center.y() + radius);
+    const int z0 = cellCoord(center.z() - radius), z1 = cellCoord(center.z() + radius);
+
+    const qint64 span = qint64(x1 - x0 + 1) * (y1 - y0 + 1) * (z1 - z0 + 1);
+    if (span > static_cast<qint64>(m_cells.size())) {
+        // Range covers more cells than are occupied: walk the occupied ones
+        for (const auto& [k, cell] : m_cells) {
+            if (cell.x < x0 || cell.x > x1 || cell.y < y0 || cell.y > y1 || cell.z < z0 || cell.z > z1)
+                continue;
+            out.insert(out.end(), cell.platforms.begin(), cell.platforms.end());
+        }
+        return;
+    }
+
+    for (int x = x0; x <= x1; ++x) {
+        for (int y = y0; y <= y1; ++y) {
+            for (int z = z0; z <= z1; ++z) {
+                auto it = m_cells.find(key(x, y, z));
+                if (it == m_cells.end()) continue;
+                out.insert(out.end(), it->second.platforms.begin(), it->second.platforms.end());
+            }
+        }
+    }
+}
+
+int SpatialGrid::cellCoord(float v) const {
+    const float c = std::floor(v / m_cellSize);
+    if (!(c > -GRID_COORD_LIMIT)) return -GRID_COORD_LIMIT; // also catches NaN
+    if (c > GRID_COORD_LIMIT) return GRID_COORD_LIMIT;
+    return static_cast<int>(c);
+}
+
+quint64 SpatialGrid::key(int x, int y, int z) {
+    const quint64 mask = 0x1FFFFF;
+    return ((quint64(x) & mask) << 42) | ((quint64(y) & mask) << 21) | (quint64(z) & mask);
+}
@@ -0,0 +1,48 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <QVector3D>
+#include <QtGlobal>
+#include <unordered_map>
+#include <vector>
+
+class Platform;
+
+// Uniform hash grid over platform positions, rebuilt once per tick.
+// Sensors query it for candidates instead of walking every entity; the
+// exact range/angle test is still done by the caller.
+class SpatialGrid
+{
+public:
+    explicit SpatialGrid(float cellSize = 100.0f);
+
+    void clear();
+    // Stops queries but leaves the cells filled for the next clear() to reuse
+    void invalidate() { m_built = false; }
+    void setCellSize(float size);
+    float cellSize() const { return m_cellSize; }
+
+    void insert(Platform* platform, const QVector3D& position);
+
+    // Appends every platform whose cell overlaps the cube around center
+    void query(const QVector3D& center, float radius, std::vector<Platform*>& out) const;
+
+    bool isBuilt() const { return m_built; }
+    int size() const { return m_count; }
+
+private:
+    struct Cell {
+        int x, y, z;
+        std::vector<Platform*> platforms;
+    };
+
+    int cellCoord(float v) const;
+    static quint64 key(int x, int y, int z);
+
+    float m_cellSize;
+    std::unordered_map<quint64, Cell> m_cells;
+    int m_count = 0;
+    bool m_built = false;
+};
+
+#endif // SPATIALGRID_H
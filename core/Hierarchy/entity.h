@@ -34,6 +34,7 @@ public:
     std::string ID;
     std::string parentID;
     Constants::EntityType type;
+    Hierarchy* parentHierarchy = nullptr; // set through GlobalRegistry::registerEntity
     std::unordered_map<std::string, std::shared_ptr<Parameter>> parameters;
     std::vector<Radio*> radioList;
     std::vector<Sensor*> sensorList;
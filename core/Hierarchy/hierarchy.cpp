@@ -4,8 +4,10 @@
 #include "core/Hierarchy/EntityProfiles/radio.h"
 #include "core/Hierarchy/EntityProfiles/iff.h"
 #include "core/Hierarchy/EntityProfiles/sensor.h"
+#include "core/Hierarchy/EntityProfiles/platform.h"
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <algorithm>
 
 // Thread-local context pointer
 thread_local Hierarchy* Hierarchy::currentContext = nullptr;
@@ -16,6 +18,10 @@ Hierarchy::Hierarchy()
     Folders = new std::unordered_map<std::string, Folder*>();
     Entities = new std::unordered_map<std::string, Entity*>();
     setCurrentContext(this);
+
+    // Direct, so the cache is stale before a removed entity can be deleted
+    connect(this, &Hierarchy::entityAdded, this, [this]() { platformCacheDirty = true; }, Qt::DirectConnection);
+    connect(this, &Hierarchy::entityRemoved, this, [this]() { platformCacheDirty = true; }, Qt::DirectConnection);
 }
 
 // Destructor
@@ -412,18 +418,37 @@ void Hierarchy::fromJson(const QJsonObject& obj)
     if (obj.contains("profileCategories") && obj["profileCategories"].isObject()) {
         QJsonObject profileCategoriesObj = obj["profileCategories"].toObject();
         for (const QString& key : profileCategoriesObj.keys()) {
-            QJsonObject catObj = profileCategoriesObj[key].toObject();
-            ProfileCategaory* profile = new ProfileCategaory(this);
-            profile->Name = catObj["name"].toString().toStdString();
-            profile->ID = catObj["id"].toString().toStdString();
-            if (profile) {
-                addProfileCategaoryWithObject(profile);
-                profile->fromJson(catObj);
-            }
+            profileFromJson(profileCategoriesObj[key].toObject());
         }
     }
 }
 
+void Hierarchy::profileFromJson(const QJsonObject& catObj)
+{
+    const QString id = catObj["id"].toString();
+    if (ProfileCategories.count(id.toStdString())) {
+        removeProfileCategaory(id);
+    }
+    ProfileCategaory* profile = new ProfileCategaory(this);
+    profile->Name = catObj["name"].toString().toStdString();
+    profile->ID = id.toStdString();
+    addProfileCategaoryWithObject(profile);
+    profile->fromJson(catObj);
+}
+
+void Hierarchy::retainProfiles(const QStringList& ids)
+{
+    std::vector<std::string> keys;
+    for (const auto& [key, profilePtr] : ProfileCategories) {
+        if (!ids.contains(QString::fromStdString(key))) {
+            keys.push_back(key);
+        }
+    }
+    for (const auto& key : keys) {
+        removeProfileCategaory(QString::fromStdString(key));
+    }
+}
+
 void Hierarchy::getCurrentJsonData()
 {
     emit getJsonData(toJson());
@@ -453,3 +478,39 @@ QJsonArray Hierarchy::searchProfile()
     Console::log("Hierarchy::searchProfile found " + std::to_string(profilesArray.size()) + " profiles");
     return profilesArray;
 }
+
+// Re-bins every platform by position. The cell size follows the median
+// sensor range, so a typical scan touches 3x3x3 cells; longer-range sensors
+// walk more cells rather than making every cell coarse.
+void Hierarchy::rebuildSpatialIndex()
+{
+    if (platformCacheDirty) {
+        platformCache.clear();
+        for (auto& [key, entity] : *Entities) {
+            if (Platform* platform = dynamic_cast<Platform*>(entity)) platformCache.push_back(platform);
+        }
+        // Query results follow insertion order; sorting by ID keeps them
+        // stable for lockstep runs and costs nothing once cached
+        std::sort(platformCache.begin(), platformCache.end(), [](Platform* a, Platform* b) { return a->ID < b->ID; });
+        platformCacheDirty = false;
+    }
+
+    sensorRanges.clear();
+    for (Platform* platform : platformCache) {
+        if (!platform->transform) continue;
+        for (Sensor* s : platform->sensorList) {
+            const float range = s ? std::max(s->range, s->ewrange) : 0.0f;
+            if (range > 0.0f) sensorRanges.push_back(range);
+        }
+    }
+    if (!sensorRanges.empty()) {
+        auto median = sensorRanges.begin() + sensorRanges.size() / 2;
+        std::nth_element(sensorRanges.begin(), median, sensorRanges.end());
+        spatialIndex.setCellSize(*median);
+    }
+
+    spatialIndex.clear();
+    for (Platform* platform : platformCache) {
+        if (platform->transform) spatialIndex.insert(platform, platform->transform->translation());
+    }
+}
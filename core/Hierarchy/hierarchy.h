@@ -5,6 +5,7 @@
 #include <QObject>
 #include <unordered_map>
 #include "./profilecategaory.h"
+#include "core/Hierarchy/Utils/spatialgrid.h"
 
 class Hierarchy : public QObject
 {
@@ -21,6 +22,7 @@ public:
     std::unordered_map<std::string, Mission*> *missionList;
     std::unordered_map<std::string, std::string*> EntityPaths;
     std::unordered_map<std::string, std::string*> FolderPaths;
+    SpatialGrid spatialIndex; // platform positions, valid during a simulation tick
 
     ProfileCategaory* addProfileCategaory(QString profileName);
     void addProfileCategaoryWithObject(ProfileCategaory *profile);
@@ -43,6 +45,10 @@ public:
 
     QJsonObject toJson();
     void fromJson(const QJsonObject& obj);
+    // One profile of toJson; replaces the profile with the same ID
+    void profileFromJson(const QJsonObject& obj);
+    // Removes every profile whose ID is not in ids
+    void retainProfiles(const QStringList& ids);
     void getCurrentJsonData();
     void addComponent(QString Id, QString ComponentName);
     void attchedIff(QString Id, QString name);
@@ -55,6 +61,7 @@ public:
 
     void onParameterChanged(const QString &entityID, const QString &componentName, const QString &key, const QString &parameterType, bool add);
     QJsonArray searchProfile();
+    void rebuildSpatialIndex(); // inserts in entity ID order
     static thread_local Hierarchy* currentContext;
     static void setCurrentContext(Hierarchy* h) {
         currentContext = h;
@@ -64,6 +71,12 @@ public:
         return currentContext;
     }
 
+private:
+    // Platforms for rebuildSpatialIndex, refreshed after entities are added or removed
+    std::vector<Platform*> platformCache;
+    bool platformCacheDirty = true;
+    std::vector<float> sensorRanges; // scratch for the median range
+
 signals:
     void profileAddedPointer(ProfileCategaory* profile);
     void folderAddedPointer(QString parentID, Folder* folder);
@@ -0,0 +1,84 @@
+#include "command.h"
+#include <QCborValue>
+#include <cstring>
+
+using namespace CommandFormat;
+
+namespace {
+template <typename T>
+void appendRaw(QByteArray& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+}
+
+bool CommandFormat::isBatchMessage(const QByteArray& message) {
+    return message.size() >= static_cast<int>(sizeof(BatchHeader)) &&
+           std::memcmp(message.constData(), BatchMagic, sizeof(BatchMagic)) == 0;
+}
+
+void CommandWriter::add(CommandFormat::Opcode opcode, const QCborArray& args) {
+    const QByteArray encoded = QCborValue(args).toCbor();
+    const quint32 length = static_cast<quint32>(encoded.size());
+    appendRaw(m_body, static_cast<quint8>(opcode));
+    appendRaw(m_body, length);
+    m_body.append(encoded);
+    m_count++;
+}
+
+QByteArray CommandWriter::finish() {
+    BatchHeader header;
+    std::memcpy(header.magic, BatchMagic, sizeof(header.magic));
+    header.version = Version;
+    header.flags = 0;
+    header.count = m_count;
+    header.rawBytes = static_cast<quint32>(m_body.size());
+
+    QByteArray body = m_body;
+    if (m_body.size() >= CompressThreshold) {
+        QByteArray compressed = qCompress(m_body);
+        if (compressed.size() < m_body.size()) {
+            body = compressed;
+            header.flags |= Compressed;
+        }
+    }
+
+    QByteArray message;
+    message.reserve(static_cast<int>(sizeof(header)) + body.size());
+    appendRaw(message, header);
+    message.append(body);
+    m_body.clear();
+    m_count = 0;
+    return message;
+}
+
+CommandReader::CommandReader(const QByteArray& message) {
+    if (!isBatchMessage(message)) return;
+    BatchHeader header;
+    std::memcpy(&header, message.constData(), sizeof(header));
+    if (header.version != Version) return;
+
+    m_body = message.mid(static_cast<int>(sizeof(header)));
+    if (header.flags & Compressed) m_body = qUncompress(m_body);
+    if (static_cast<quint32>(m_body.size()) != header.rawBytes) return;
+    m_left = header.count;
+    m_valid = true;
+}
+
+bool CommandReader::next(quint8& opcode, QCborArray& args) {
+    if (!m_valid || m_left == 0) return false;
+    quint32 length = 0;
+    const size_t size = static_cast<size_t>(m_body.size());
+    const size_t offset = static_cast<size_t>(m_offset);
+    if (size - offset < sizeof(opcode) + sizeof(length)) return m_valid = false;
+    std::memcpy(&opcode, m_body.constData() + offset, sizeof(opcode));
+    std::memcpy(&length, m_body.constData() + offset + sizeof(opcode), sizeof(length));
+    const size_t start = offset + sizeof(opcode) + sizeof(length);
+    if (size - start < length) return m_valid = false;
+
+    const QCborValue value = QCborValue::fromCbor(QByteArray::fromRawData(m_body.constData() + start, static_cast<int>(length)));
+    if (!value.isArray()) return m_valid = false;
+    args = value.toArray();
+    m_offset = static_cast<int>(start + length);
+    m_left--;
+    return true;
+}
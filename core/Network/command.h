@@ -0,0 +1,101 @@
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <QByteArray>
+#include <QCborArray>
+#include <QtGlobal>
+
+// Reliable scene commands, server to clients, as binary WebSocket messages
+// in host order (little-endian):
+//
+//   batch     BatchHeader, then count commands, each
+//             quint8 opcode, quint32 length, CBOR array of the arguments
+//
+// With the Compressed flag everything after the header is qCompress'd.
+// The server queues commands as the hierarchy changes and sends them once
+// per event loop pass, so a bulk import of thousands of entities goes out
+// as a few batches instead of a JSON message each. Receivers index a table
+// by opcode; opcodes they do not know are skipped.
+namespace CommandFormat {
+
+const char BatchMagic[2] = {'E', 'C'};
+const quint8 Version = 1;
+const int MaxBatchBytes = 1024 * 1024;  // uncompressed, a batch is cut after the command crossing it
+const int CompressThreshold = 4 * 1024; // smaller batches are not worth compressing
+
+enum BatchFlags : quint8 {
+    Compressed = 1
+};
+
+// Arguments in order; IDs and names are strings
+enum Opcode : quint8 {
+    AddProfile,      // id, name
+    RemoveProfile,   // id
+    RenameProfile,   // id, name
+    AddFolder,       // id, parentID, name
+    RemoveFolder,    // id
+    RenameFolder,    // id, name
+    AddEntity,       // id, parentID, name
+    AddEntityJson,   // parentID, Entity::toJson map
+    RemoveEntity,    // id, parentID, profile
+    RenameEntity,    // id, name
+    UpdateEntity,    // id
+    AddComponent,    // id, name
+    UpdateComponent, // id, name, delta map
+    RemoveComponent, // parentID, name
+    AddMesh,         // entityID
+    RemoveMesh,      // entityID
+    AddPhysics,      // entityID
+    RemovePhysics,   // entityID
+    UpdateTracks,    // sensor id, entered, updated, lost; tracks are [target, ew, angle, radius]
+    OpcodeCount
+};
+
+#pragma pack(push, 1)
+struct BatchHeader {
+    char magic[2];
+    quint8 version;
+    quint8 flags;
+    quint32 count;
+    quint32 rawBytes; // commands before compression
+};
+#pragma pack(pop)
+
+bool isBatchMessage(const QByteArray& message);
+
+}
+
+// Server side: collects commands into one batch message
+class CommandWriter
+{
+public:
+    void add(CommandFormat::Opcode opcode, const QCborArray& args);
+    bool isEmpty() const { return m_count == 0; }
+    int pendingBytes() const { return m_body.size(); }
+    // The batch message; the writer is empty again afterwards
+    QByteArray finish();
+
+private:
+    QByteArray m_body;
+    quint32 m_count = 0;
+};
+
+// Client side: walks the commands of one batch message
+class CommandReader
+{
+public:
+    explicit CommandReader(const QByteArray& message);
+
+    bool isValid() const { return m_valid; }
+    // False after the last command or at a malformed one
+    bool next(quint8& opcode, QCborArray& args);
+    bool atEnd() const { return m_valid && m_left == 0; }
+
+private:
+    QByteArray m_body;
+    int m_offset = 0;
+    quint32 m_left = 0;
+    bool m_valid = false;
+};
+
+#endif // COMMAND_H
@@ -0,0 +1,335 @@
+#include "entitystate.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace EntityStateFormat;
+
+namespace {
+const float ComponentRange = 0.70710678f; // |non-largest component| <= 1/sqrt(2)
+const int ComponentBits = 10;
+const float ComponentMax = (1 << ComponentBits) - 1;
+
+qint32 quantisePosition(float value) {
+    const double steps = std::round(double(value) * PositionScale);
+    return static_cast<qint32>(std::max(-2147483647.0, std::min(2147483647.0, steps)));
+}
+
+template <typename T>
+void appendRaw(QByteArray& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void appendString(QByteArray& out, const std::string& text) {
+    const quint16 length = static_cast<quint16>(std::min<size_t>(text.size(), 0xFFFF));
+    appendRaw(out, length);
+    out.append(text.data(), length);
+}
+
+bool readString(const QByteArray& message, size_t& offset, std::string& out) {
+    const size_t size = static_cast<size_t>(message.size());
+    quint16 length = 0;
+    if (size - offset < sizeof(length)) return false;
+    std::memcpy(&length, message.constData() + offset, sizeof(length));
+    offset += sizeof(length);
+    if (size - offset < length) return false;
+    out.assign(message.constData() + offset, length);
+    offset += length;
+    return true;
+}
+}
+
+int EntityStateFormat::statesWithin(int bytes) {
+    const int header = static_cast<int>(sizeof(PacketHeader));
+    const int row = static_cast<int>(sizeof(EntityState));
+    const int full = header + StatesPerDatagram * row;
+    const int rest = bytes % full - header;
+    return bytes / full * StatesPerDatagram + (rest > 0 ? rest / row : 0);
+}
+
+quint32 EntityStateFormat::packOrientation(const QQuaternion& q) {
+    float c[4] = {q.scalar(), q.x(), q.y(), q.z()};
+    int largest = 0;
+    for (int i = 1; i < 4; ++i) {
+        if (std::abs(c[i]) > std::abs(c[largest])) largest = i;
+    }
+    // q and -q are the same rotation; send the one with a positive largest
+    const float sign = c[largest] < 0 ? -1.0f : 1.0f;
+    quint32 packed = static_cast<quint32>(largest) << (3 * ComponentBits);
+    int shift = 2 * ComponentBits;
+    for (int i = 0; i < 4; ++i) {
+        if (i == largest) continue;
+        const float unit = std::max(-1.0f, std::min(1.0f, sign * c[i] / ComponentRange));
+        packed |= static_cast<quint32>(std::lround((unit * 0.5f + 0.5f) * ComponentMax)) << shift;
+        shift -= ComponentBits;
+    }
+    return packed;
+}
+
+QQuaternion EntityStateFormat::unpackOrientation(quint32 packed) {
+    const int largest = static_cast<int>(packed >> (3 * ComponentBits));
+    float c[4];
+    float squares = 0.0f;
+    int shift = 2 * ComponentBits;
+    for (int i = 0; i < 4; ++i) {
+        if (i == largest) continue;
+        const quint32 bits = (packed >> shift) & static_cast<quint32>(ComponentMax);
+        c[i] = (bits / ComponentMax * 2.0f - 1.0f) * ComponentRange;
+        squares += c[i] * c[i];
+        shift -= ComponentBits;
+    }
+    c[largest] = std::sqrt(std::max(0.0f, 1.0f - squares));
+    return QQuaternion(c[0], c[1], c[2], c[3]);
+}
+
+EntityState EntityStateFormat::makeState(quint16 index, const QVector3D& position, const QQuaternion& orientation) {
+    EntityState state;
+    state.index = index;
+    state.position[0] = quantisePosition(position.x());
+    state.position[1] = quantisePosition(position.y());
+    state.position[2] = quantisePosition(position.z());
+    state.orientation = packOrientation(orientation);
+    return state;
+}
+
+QVector3D EntityStateFormat::statePosition(const EntityState& state) {
+    return QVector3D(state.position[0] / PositionScale, state.position[1] / PositionScale, state.position[2] / PositionScale);
+}
+
+QByteArray EntityStateFormat::encodeIndex(const std::vector<std::pair<quint16, std::string>>& entries) {
+    IndexHeader header;
+    std::memcpy(header.magic, IndexMagic, sizeof(header.magic));
+    header.version = Version;
+    header.reserved = 0;
+    header.count = static_cast<quint32>(entries.size());
+
+    QByteArray message;
+    appendRaw(message, header);
+    for (const auto& entry : entries) {
+        const quint16 length = static_cast<quint16>(std::min<size_t>(entry.second.size(), 0xFFFF));
+        appendRaw(message, entry.first);
+        appendRaw(message, length);
+        message.append(entry.second.data(), length);
+    }
+    return message;
+}
+
+bool EntityStateFormat::isIndexMessage(const QByteArray& message) {
+    return message.size() >= static_cast<int>(sizeof(IndexHeader)) &&
+           std::memcmp(message.constData(), IndexMagic, sizeof(IndexMagic)) == 0;
+}
+
+bool EntityStateFormat::decodeIndex(const QByteArray& message, std::vector<std::pair<quint16, std::string>>& out) {
+    out.clear();
+    if (!isIndexMessage(message)) return false;
+    IndexHeader header;
+    std::memcpy(&header, message.constData(), sizeof(header));
+    if (header.version != Version) return false;
+
+    const char* data = message.constData();
+    size_t offset = sizeof(header);
+    const size_t size = static_cast<size_t>(message.size());
+    for (quint32 i = 0; i < header.count; ++i) {
+        quint16 index = 0, length = 0;
+        if (size - offset < sizeof(index) + sizeof(length)) return false;
+        std::memcpy(&index, data + offset, sizeof(index));
+        std::memcpy(&length, data + offset + sizeof(index), sizeof(length));
+        offset += sizeof(index) + sizeof(length);
+        if (size - offset < length) return false;
+        out.emplace_back(index, std::string(data + offset, length));
+        offset += length;
+    }
+    return true;
+}
+
+QByteArray EntityStateFormat::encodeAck(quint32 sequence) {
+    AckMessage ack;
+    std::memcpy(ack.magic, AckMagic, sizeof(ack.magic));
+    ack.version = Version;
+    ack.reserved = 0;
+    ack.sequence = sequence;
+    return QByteArray(reinterpret_cast<const char*>(&ack), sizeof(ack));
+}
+
+bool EntityStateFormat::decodeAck(const QByteArray& message, quint32& sequence) {
+    if (message.size() != static_cast<int>(sizeof(AckMessage))) return false;
+    AckMessage ack;
+    std::memcpy(&ack, message.constData(), sizeof(ack));
+    if (std::memcmp(ack.magic, AckMagic, sizeof(AckMagic)) != 0 || ack.version != Version) return false;
+    sequence = ack.sequence;
+    return true;
+}
+
+bool InterestArea::contains(const QVector3D& position, float grow) const {
+    switch (shape) {
+    case Box:
+        return position.x() >= minimum.x() - grow && position.x() <= maximum.x() + grow &&
+               position.y() >= minimum.y() - grow && position.y() <= maximum.y() + grow &&
+               position.z() >= minimum.z() - grow && position.z() <= maximum.z() + grow;
+    case Sphere:
+        return (position - center).lengthSquared() <= (radius + grow) * (radius + grow);
+    default:
+        return true;
+    }
+}
+
+QVector3D InterestArea::boundsCenter() const {
+    return shape == Box ? (minimum + maximum) * 0.5f : center;
+}
+
+float InterestArea::boundsRadius() const {
+    if (shape == Box) {
+        const QVector3D half = (maximum - minimum) * 0.5f;
+        return std::max(half.x(), std::max(half.y(), half.z())) + margin;
+    }
+    return radius + margin;
+}
+
+QByteArray InterestArea::encode() const {
+    InterestHeader header;
+    std::memcpy(header.magic, InterestMagic, sizeof(header.magic));
+    header.version = Version;
+    header.shape = shape;
+    const QVector3D first = shape == Box ? minimum : center;
+    const QVector3D second = shape == Box ? maximum : QVector3D(radius, 0.0f, 0.0f);
+    for (int i = 0; i < 3; ++i) {
+        header.minimum[i] = first[i];
+        header.maximum[i] = second[i];
+    }
+    header.margin = margin;
+    header.typeMask = typeMask;
+    header.sideCount = static_cast<quint16>(std::min<size_t>(sides.size(), 0xFFFF));
+
+    QByteArray message;
+    appendRaw(message, header);
+    for (quint16 i = 0; i < header.sideCount; ++i) appendString(message, sides[i]);
+    return message;
+}
+
+bool InterestArea::decode(const QByteArray& message, InterestArea& out) {
+    if (message.size() < static_cast<int>(sizeof(InterestHeader))) return false;
+    InterestHeader header;
+    std::memcpy(&header, message.constData(), sizeof(header));
+    if (std::memcmp(header.magic, InterestMagic, sizeof(InterestMagic)) != 0 || header.version != Version) return false;
+    if (header.shape > Sphere) return false;
+
+    InterestArea area;
+    area.shape = static_cast<Shape>(header.shape);
+    const QVector3D first(header.minimum[0], header.minimum[1], header.minimum[2]);
+    const QVector3D second(header.maximum[0], header.maximum[1], header.maximum[2]);
+    if (area.shape == Box) {
+        area.minimum = first;
+        area.maximum = second;
+    } else {
+        area.center = first;
+        area.radius = std::max(0.0f, second.x());
+    }
+    area.margin = std::max(0.0f, header.margin);
+    area.typeMask = header.typeMask;
+
+    size_t offset = sizeof(header);
+    area.sides.resize(header.sideCount);
+    for (std::string& side : area.sides) {
+        if (!readString(message, offset, side)) return false;
+    }
+    out = std::move(area);
+    return true;
+}
+
+QByteArray EntityStateFormat::encodeSelection(const std::vector<std::string>& ids) {
+    SelectionHeader header;
+    std::memcpy(header.magic, SelectionMagic, sizeof(header.magic));
+    header.version = Version;
+    header.reserved = 0;
+    header.count = static_cast<quint32>(ids.size());
+
+    QByteArray message;
+    appendRaw(message, header);
+    for (const std::string& id : ids) appendString(message, id);
+    return message;
+}
+
+// out is left alone unless the whole message is valid
+bool EntityStateFormat::decodeSelection(const QByteArray& message, std::vector<std::string>& out) {
+    if (message.size() < static_cast<int>(sizeof(SelectionHeader))) return false;
+    SelectionHeader header;
+    std::memcpy(&header, message.constData(), sizeof(header));
+    if (std::memcmp(header.magic, SelectionMagic, sizeof(SelectionMagic)) != 0 || header.version != Version) return false;
+
+    size_t offset = sizeof(header);
+    std::string id;
+    std::vector<std::string> ids;
+    for (quint32 i = 0; i < header.count; ++i) {
+        if (!readString(message, offset, id)) return false;
+        ids.push_back(id);
+    }
+    out.swap(ids);
+    return true;
+}
+
+void EntityStateWriter::begin(quint32 sequence, double serverTime, quint32 baseline, bool deferred) {
+    m_sequence = sequence;
+    m_baseline = baseline;
+    m_deferred = deferred;
+    m_serverTime = serverTime;
+    m_states.clear();
+}
+
+void EntityStateWriter::add(quint16 index, const QVector3D& position, const QQuaternion& orientation) {
+    m_states.push_back(makeState(index, position, orientation));
+}
+
+const std::vector<QByteArray>& EntityStateWriter::finish() {
+    const int total = static_cast<int>(m_states.size());
+    const int parts = std::max(1, (total + StatesPerDatagram - 1) / StatesPerDatagram);
+    m_datagrams.resize(parts);
+
+    PacketHeader header;
+    std::memcpy(header.magic, StateMagic, sizeof(header.magic));
+    header.version = Version;
+    header.flags = (m_baseline ? DeltaSnapshot : 0) | (m_deferred ? Deferred : 0);
+    header.sequence = m_sequence;
+    header.baseline = m_baseline;
+    header.serverTime = m_serverTime;
+    header.partCount = static_cast<quint16>(parts);
+    for (int part = 0; part < parts; ++part) {
+        const int first = part * StatesPerDatagram;
+        const int count = std::min(StatesPerDatagram, total - first);
+        header.part = static_cast<quint16>(part);
+        header.count = static_cast<quint16>(count);
+
+        QByteArray& datagram = m_datagrams[part];
+        datagram.resize(static_cast<int>(sizeof(header) + count * sizeof(EntityState)));
+        std::memcpy(datagram.data(), &header, sizeof(header));
+        if (count > 0) std::memcpy(datagram.data() + sizeof(header), &m_states[first], count * sizeof(EntityState));
+    }
+    return m_datagrams;
+}
+
+EntityStateView::EntityStateView(const QByteArray& datagram) {
+    if (datagram.size() < static_cast<int>(sizeof(PacketHeader))) return;
+    std::memcpy(&m_header, datagram.constData(), sizeof(m_header));
+    m_valid = std::memcmp(m_header.magic, StateMagic, sizeof(StateMagic)) == 0 && m_header.version == Version &&
+              datagram.size() >= static_cast<int>(sizeof(PacketHeader) + m_header.count * sizeof(EntityState));
+    m_states = datagram.constData() + sizeof(PacketHeader);
+}
+
+EntityState EntityStateView::state(int i) const {
+    EntityState s;
+    std::memcpy(&s, m_states + i * sizeof(EntityState), sizeof(s));
+    return s;
+}
+
+quint16 EntityStateView::index(int i) const {
+    quint16 index;
+    std::memcpy(&index, m_states + i * sizeof(EntityState), sizeof(index));
+    return index;
+}
+
+QVector3D EntityStateView::position(int i) const {
+    return statePosition(state(i));
+}
+
+QQuaternion EntityStateView::orientation(int i) const {
+    return unpackOrientation(state(i).orientation);
+}
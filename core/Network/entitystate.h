@@ -0,0 +1,220 @@
+#ifndef ENTITYSTATE_H
+#define ENTITYSTATE_H
+
+#include <QByteArray>
+#include <QQuaternion>
+#include <QVector3D>
+#include <QtGlobal>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Wire format of the per-tick entity state stream, little-endian:
+//
+//   state datagram (UDP)   PacketHeader, EntityState[count]
+//   index message (WS)     IndexHeader, then per entry
+//                          quint16 index, quint16 idLength, id
+//   ack message (WS)       AckMessage, client to server
+//   interest message (WS)  InterestHeader, then per side
+//                          quint16 length, name; client to server
+//   selection message (WS) SelectionHeader, then per entity
+//                          quint16 length, ID; client to server
+//
+// Entities are named by a dense index the server hands out once per entity
+// ID and announces on the reliable channel, so a state row is 18 bytes
+// instead of a JSON key and four printed numbers. A tick that does not fit
+// one datagram is split into parts that each decode on their own.
+//
+// A delta snapshot only carries the rows that differ from the baseline, an
+// earlier snapshot the client acknowledged; the client rebuilds the full
+// snapshot from its copy of the baseline. Without a usable ack the server
+// sends a full snapshot.
+//
+// A client that registered an area of interest only gets rows for the
+// entities inside it; one that leaves the area simply stops being sent.
+// Under a byte budget the server may hold changed rows back for a later
+// tick, which the Deferred flag tells the client.
+namespace EntityStateFormat {
+
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "state packets are written in host order");
+
+const char StateMagic[2] = {'E', 'S'};
+const char IndexMagic[2] = {'E', 'I'};
+const char AckMagic[2] = {'E', 'A'};
+const char InterestMagic[2] = {'E', 'V'};
+const char SelectionMagic[2] = {'E', 'P'};
+const quint8 Version = 3;
+const float PositionScale = 100.0f; // steps per metre, 1 cm resolution
+const int MaxDatagram = 1200;       // stays under a typical path MTU
+const quint16 NoEntity = 0xFFFF;    // snapshot row of an index not streamed at that tick
+const int SnapshotHistory = 64;     // snapshots both sides keep as possible baselines
+const quint32 MaxDeltaAge = 32;     // ticks without a fresher ack before a full resync
+
+enum PacketFlags : quint8 {
+    DeltaSnapshot = 1, // rows are only the changes since baseline
+    Deferred = 2       // some changed rows were left for a later tick
+};
+
+#pragma pack(push, 1)
+struct PacketHeader {
+    char magic[2];
+    quint8 version;
+    quint8 flags;
+    quint32 sequence;  // server tick, shared by every part of it
+    quint32 baseline;  // sequence the delta is against, DeltaSnapshot only
+    double serverTime; // seconds since the server started streaming
+    quint16 part;
+    quint16 partCount;
+    quint16 count;
+};
+
+struct EntityState {
+    quint16 index;
+    qint32 position[3];  // metres * PositionScale
+    quint32 orientation; // smallest three, see packOrientation
+};
+
+struct IndexHeader {
+    char magic[2];
+    quint8 version;
+    quint8 reserved;
+    quint32 count;
+};
+
+struct AckMessage {
+    char magic[2];
+    quint8 version;
+    quint8 reserved;
+    quint32 sequence; // newest snapshot received complete
+};
+
+struct InterestHeader {
+    char magic[2];
+    quint8 version;
+    quint8 shape;        // InterestArea::Shape
+    float minimum[3];    // Box: lower corner, Sphere: center
+    float maximum[3];    // Box: upper corner, Sphere: radius in [0]
+    float margin;
+    quint32 typeMask;
+    quint16 sideCount;
+};
+
+struct SelectionHeader {
+    char magic[2];
+    quint8 version;
+    quint8 reserved;
+    quint32 count;
+};
+#pragma pack(pop)
+
+const int StatesPerDatagram = (MaxDatagram - static_cast<int>(sizeof(PacketHeader))) / static_cast<int>(sizeof(EntityState));
+// Rows that fit in bytes worth of datagrams, headers included
+int statesWithin(int bytes);
+
+// Largest component index in 2 bits, the other three in 10 bits each
+quint32 packOrientation(const QQuaternion& q);
+QQuaternion unpackOrientation(quint32 packed);
+
+EntityState makeState(quint16 index, const QVector3D& position, const QQuaternion& orientation);
+inline bool sameState(const EntityState& a, const EntityState& b) {
+    return a.index == b.index && a.position[0] == b.position[0] && a.position[1] == b.position[1] &&
+           a.position[2] == b.position[2] && a.orientation == b.orientation;
+}
+QVector3D statePosition(const EntityState& state);
+
+QByteArray encodeIndex(const std::vector<std::pair<quint16, std::string>>& entries);
+bool decodeIndex(const QByteArray& message, std::vector<std::pair<quint16, std::string>>& out);
+bool isIndexMessage(const QByteArray& message);
+
+QByteArray encodeAck(quint32 sequence);
+bool decodeAck(const QByteArray& message, quint32& sequence);
+
+QByteArray encodeSelection(const std::vector<std::string>& ids);
+bool decodeSelection(const QByteArray& message, std::vector<std::string>& out);
+
+}
+
+// What one client wants streamed. An entity enters once it is inside the
+// area and passes the filters, and only leaves again once it is margin
+// metres outside, so entities on the edge do not flicker in and out.
+struct InterestArea {
+    enum Shape : quint8 {
+        Everything,
+        Box,
+        Sphere
+    };
+    Shape shape = Everything;
+    QVector3D minimum, maximum;     // Box corners
+    QVector3D center;               // Sphere
+    float radius = 0.0f;
+    float margin = 0.0f;
+    quint32 typeMask = 0xFFFFFFFF;  // bit per Constants::EntityType
+    std::vector<std::string> sides; // "side" platform parameter, empty for every side
+
+    bool isFiltered() const { return shape != Everything || typeMask != 0xFFFFFFFF || !sides.empty(); }
+    bool contains(const QVector3D& position, float grow = 0.0f) const;
+    // Cube around the area grown by margin, for grid queries
+    QVector3D boundsCenter() const;
+    float boundsRadius() const;
+
+    QByteArray encode() const;
+    static bool decode(const QByteArray& message, InterestArea& out);
+};
+
+// Quantised state of every streamed entity at one tick, by wire index
+struct EntitySnapshot {
+    quint32 sequence = 0;
+    double time = 0.0; // server time the tick was taken
+    std::vector<EntityStateFormat::EntityState> rows; // rows[i].index is i, or NoEntity
+};
+
+// Server side: packs one tick of entity states into datagrams. Buffers are
+// kept between ticks.
+class EntityStateWriter
+{
+public:
+    void begin(quint32 sequence, double serverTime, quint32 baseline = 0, bool deferred = false); // baseline 0: full snapshot
+    void add(quint16 index, const QVector3D& position, const QQuaternion& orientation);
+    void add(const EntityStateFormat::EntityState& state) { m_states.push_back(state); }
+    const std::vector<QByteArray>& finish();
+
+    int stateCount() const { return static_cast<int>(m_states.size()); }
+
+private:
+    quint32 m_sequence = 0;
+    quint32 m_baseline = 0;
+    bool m_deferred = false;
+    double m_serverTime = 0.0;
+    std::vector<EntityStateFormat::EntityState> m_states;
+    std::vector<QByteArray> m_datagrams;
+};
+
+// Client side: reads a received datagram in place, nothing is parsed up
+// front or copied out. The datagram must outlive the view.
+class EntityStateView
+{
+public:
+    explicit EntityStateView(const QByteArray& datagram);
+
+    bool isValid() const { return m_valid; }
+    quint32 sequence() const { return m_header.sequence; }
+    bool isDelta() const { return m_header.flags & EntityStateFormat::DeltaSnapshot; }
+    bool isDeferred() const { return m_header.flags & EntityStateFormat::Deferred; }
+    quint32 baseline() const { return m_header.baseline; }
+    double serverTime() const { return m_header.serverTime; }
+    int part() const { return m_header.part; }
+    int partCount() const { return m_header.partCount; }
+    int count() const { return m_valid ? m_header.count : 0; }
+
+    quint16 index(int i) const;
+    QVector3D position(int i) const;
+    QQuaternion orientation(int i) const;
+    EntityStateFormat::EntityState state(int i) const; // quantised row
+
+private:
+    const char* m_states = nullptr;
+    EntityStateFormat::PacketHeader m_header = {};
+    bool m_valid = false;
+};
+
+#endif // ENTITYSTATE_H
@@ -7,8 +7,12 @@
 #include <QNetworkInterface>
 #include <QJsonObject>//>
 #include <QJsonDocument>
+#include <QCborMap>
 #include <QFile>
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 // std::unique_ptr<Server> NetworkManager::ser = nullptr;
 // std::unique_ptr<Client> NetworkManager::cli = nullptr;
@@ -20,8 +24,32 @@ NetworkManager::NetworkManager(QObject* parent) : QObject(parent) {
 
     network = new NetworkTransport();
     connect(network,&NetworkTransport::onConnect,this,&NetworkManager::onConnect);
+    connect(network,&NetworkTransport::onDisconnect,this,&NetworkManager::onDisconnect);
     connect(network,&NetworkTransport::onNewConnection,this,&NetworkManager::onNewConnction);
     connect(network,&NetworkTransport::onReceivedMessage,this,&NetworkManager::onMessaageRecevied);
+    connect(network,&NetworkTransport::onBinaryMessage,this,&NetworkManager::onBinaryMessage);
+    connect(network,&NetworkTransport::onStateDatagram,this,&NetworkManager::onStateDatagram);
+    connect(network,&NetworkTransport::onClientConnected,this,&NetworkManager::onClientConnected);
+    connect(network,&NetworkTransport::onClientDisconnected,this,&NetworkManager::onClientDisconnected);
+    connect(network,&NetworkTransport::onClientMessage,this,&NetworkManager::onClientMessage);
+    connect(network,&NetworkTransport::onClientBinaryMessage,this,&NetworkManager::onClientBinaryMessage);
+    connect(network,&NetworkTransport::onClientMetrics,this,&NetworkManager::onClientMetrics);
+
+    renderTimer = new QTimer(this);
+    renderTimer->setTimerType(Qt::PreciseTimer);
+    renderTimer->setInterval(1000 / RenderRate);
+    connect(renderTimer, &QTimer::timeout, this, &NetworkManager::renderStates);
+
+    // Ticks keep going while the simulation is paused, so clients still
+    // get state and acks flow
+    stateTickTimer = new QTimer(this);
+    stateTickTimer->setTimerType(Qt::PreciseTimer);
+    stateTickTimer->setInterval(1000 / stateTickRate);
+    connect(stateTickTimer, &QTimer::timeout, this, &NetworkManager::UpdateClient);
+
+    worldSyncTimer = new QTimer(this);
+    worldSyncTimer->setInterval(10);
+    connect(worldSyncTimer, &QTimer::timeout, this, &NetworkManager::sendWorldSync);
 }
 
 QString getLocalIP() {
@@ -38,134 +66,84 @@ void NetworkManager::init(const QString& ip, int port){
 
 bool NetworkManager::startServer(int port) {
     network->start(true);
+    publishSharedState(SharedStateFormat::keyForPort(port));
+    stateTickTimer->start();
     return true;
 }
 
+bool NetworkManager::publishSharedState(const QString& key) {
+    sharedIndexCount = 0; // the first frame carries the index
+    if (!sharedState.open(key)) return false;
+    stateTickTimer->start();
+    return true;
+}
+
+void NetworkManager::setNetworkTickRate(int ticksPerSecond) {
+    stateTickRate = std::max(1, std::min(ticksPerSecond, 1000));
+    stateTickTimer->setInterval(1000 / stateTickRate);
+}
+
 void NetworkManager::onNewConnction(){
 
 }
 
 void NetworkManager::onConnect(){
+    // Commands until the sync begins describe a world the sync replaces
+    syncing = true;
+    syncDeferred.clear();
+    resetStateStream();
     network->sendMessage("give me");
+    if (clientInterest.isFiltered()) network->sendBinaryMessage(clientInterest.encode());
+    if (!clientSelection.empty()) network->sendBinaryMessage(EntityStateFormat::encodeSelection(clientSelection));
 }
 
-void NetworkManager::onMessaageRecevied(QString message) {
+void NetworkManager::onDisconnect(){
+    if (network->isServer()) return; // raised per client there
+    resetStateStream();
+}
 
+// A server that restarted counts ticks from 1 again: without this its ticks
+// would look older than the last one seen and be dropped, and its deltas
+// could resolve against baselines from the previous session
+void NetworkManager::resetStateStream(){
+    hasStateSequence = false;
+    receivedSnapshots.clear();
+    buildingSnapshot = EntitySnapshot();
+    buildingParts.clear();
+    buildingPartsLeft = 0;
+    buildingUsable = false;
+    stateInterpolator.reset();
+    renderTimer->stop();
+}
+
+void NetworkManager::setInterest(const InterestArea& area){
+    clientInterest = area;
+    if (!network->isServer()) network->sendBinaryMessage(area.encode());
+}
+
+void NetworkManager::setSelection(const std::vector<std::string>& ids){
+    clientSelection = ids;
+    if (!network->isServer()) network->sendBinaryMessage(EntityStateFormat::encodeSelection(ids));
+}
+
+// Text is only "give me" and the legacy whole-world init; scene changes
+// arrive as command batches, see applyCommands
+void NetworkManager::onMessaageRecevied(QString message) {
     if(message.contains("give me")){
-        emit getCurrentJsonData();
+        return; // answered per client, see onClientMessage
+    }
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(message.toUtf8(), &parseError);
+    if (!doc.isObject()) {
+        qWarning() << "[NetworkManager] Unexpected text message:" << parseError.errorString();
         return;
     }
-            qDebug() << "[Client] Message received:" << message;
-
-            QByteArray byteArray = QByteArray::fromStdString(message.toStdString());
-            QJsonParseError parseError;
-            QJsonDocument doc = QJsonDocument::fromJson(byteArray, &parseError);
-
-            if (doc.isNull() || !doc.isObject()) {
-                qDebug() << "[Client] Failed to parse JSON:" << parseError.errorString();
-
-            }else{
-                qDebug() << "done";
-                QJsonObject obj = doc.object();
-                QString role = obj.value("role").toString();
-                QString type = obj.value("type").toString();
-                qDebug() <<"work2";
-            if (role == "init" && type == "data") {
-                emit initData(obj); // Only pass expected 3 arguments
-
-            }else
-            if(role == "add" && type == "folder") {
-                QString parentID = obj.value("parentID").toString();
-                QString ID = obj.value("id").toString();
-                QString name = obj.value("name").toString();
-                qDebug() <<"work";
-                emit addFolder(parentID,ID, name, true);  // Only pass expected 3 arguments
-            }else
-            if(role == "remove" && type == "folder") {
-                QString Id = obj.value("id").toString();
-                qDebug() <<"work remove entity";
-                emit removeFolder(Id);  // Only pass expected 3 arguments
-            }else
-            if(role == "add" && type == "entity") {
-                QString parentID = obj.value("parentID").toString();
-                QString ID = obj.value("id").toString();
-                QString name = obj.value("name").toString();
-                qDebug() <<"work";
-                emit addEntity(parentID,ID, name, true);  // Only pass expected 3 arguments
-
-            }else
-            if(role == "add" && type == "entityJson") {
-                QString parentID = obj.value("parentID").toString();
-                QString name = obj.value("name").toString();
-                qDebug() <<"work entityjson";
-                emit addEntityFromJson(parentID, obj, false);  // Only pass expected 3 arguments
-            }else
-            if(role == "add" && type == "component") {
-                QString Id = obj.value("id").toString();
-                QString name = obj.value("name").toString();
-                qDebug() <<"work component";
-                emit addComponent(Id, name);  // Only pass expected 3 arguments
-            }else
-            if(role == "update" && type == "component") {
-                QString Id = obj.value("id").toString();
-                QString name = obj.value("name").toString();
-                QJsonObject delta = obj.value("delta").toObject();
-                qDebug() <<"work component";
-                emit entityComponentUpdate(Id, name, delta);  // Only pass expected 3 arguments
-            }else
-            if(role == "remove" && type == "entity") {
-                QString Id = obj.value("id").toString();
-                QString parentId = obj.value("parentId").toString();
-                bool profile = obj.value("Profile").toBool();
-                qDebug() <<"work remove entity";
-                emit removeEntity(parentId,Id, profile);  // Only pass expected 3 arguments
-            }else
-            if(role == "update" && type == "frame") {
-                QJsonObject delta = obj.value("delta").toObject();
-                for (auto it = delta.begin(); it != delta.end(); ++it)
-                {
-                    QString entityID = it.key();
-                    QJsonValue positionValue = it.value();
-
-                    if (!positionValue.isArray()) {
-                            qWarning() << "Position data for entity" << entityID << "is not an array.";
-                            continue;
-                        }
-
-                    QJsonArray positionArray = positionValue.toArray();
-
-                    if (positionArray.size() < 3) {
-                        qWarning() << "Position array for entity" << entityID << "does not have 3 components (x, y, z).";
-                        continue;
-                    }
-                QVector3D newPos(
-                    (float)positionArray.at(0).toDouble(), // X
-                    (float)positionArray.at(1).toDouble(), // Y
-                    (float)positionArray.at(2).toDouble()  // Z
-                    );
-                QVector3D rot(0,(float)positionArray.at(3).toDouble(),0);
-
-                auto entityMap = hierarchy->Entities;
-                if (entityMap->count(entityID.toStdString())) {
-                            Entity* entity = entityMap->at(entityID.toStdString());
-                            Platform* platform = dynamic_cast<Platform*>(entity);
-                            if (platform) {
-                                if (platform->transform) {
-                                    platform->transform->setTranslation(newPos);
-                                    platform->transform->setFromEulerAngles(rot);
-                                } else {
-                                    qWarning() << "Platform" << entityID << "is missing a Transform component.";
-                                }
-                            }
-                        } else {
-                            //qWarning() << "Entity with ID" << entityID << "not found in hierarchy.";
-                        }
-                    }
-                }
-            if(!network->isServer())emit updateScene(0.01f);
-
-        }
-
+    const QJsonObject obj = doc.object();
+    if (obj.value("role").toString() == "init" && obj.value("type").toString() == "data") {
+        emit initData(obj);
+        stateTargetsDirty = true;
+        if(!network->isServer())emit updateScene(0.01f);
+    }
 }
 
 bool NetworkManager::startClient() {
@@ -183,11 +161,86 @@ void NetworkManager::getJsonData(const QJsonObject& obj){
 void NetworkManager::sendJson(const QJsonObject& obj) {
     if(!network->isServer()) return;
     QJsonDocument doc(obj);
-    QString msg = doc.toJson(QJsonDocument::Compact);
-    std::string stdMsg = msg.toStdString();
-    std::cout << "Log: " << stdMsg << std::endl;
-    //qDebug() << "[NetworkManager JSON] Sending:" << &stdMsg;
-    network->sendMessage(msg);
+    network->sendMessage(doc.toJson(QJsonDocument::Compact));
+}
+
+// Commands wait for the end of the current event loop pass, so everything
+// one user action or import changes goes out as one batch
+void NetworkManager::queueCommand(CommandFormat::Opcode opcode, const QCborArray& args){
+    if(!network->isServer()) return;
+    commandWriter.add(opcode, args);
+    if (commandWriter.pendingBytes() >= CommandFormat::MaxBatchBytes) {
+        flushCommands();
+    } else if (!commandFlushPending) {
+        commandFlushPending = true;
+        QTimer::singleShot(0, this, &NetworkManager::flushCommands);
+    }
+}
+
+void NetworkManager::flushCommands(){
+    commandFlushPending = false;
+    if (commandWriter.isEmpty()) return;
+    network->sendBinaryMessage(commandWriter.finish());
+}
+
+// One table lookup per command; opcodes without a handler change nothing
+// on a client, as before
+void NetworkManager::applyCommands(const QByteArray& message){
+    if (syncing) {
+        syncDeferred.push_back(message); // newer than the world being synced
+        return;
+    }
+    using Handler = void (*)(NetworkManager&, const QCborArray&);
+    static const std::array<Handler, CommandFormat::OpcodeCount> handlers = [] {
+        std::array<Handler, CommandFormat::OpcodeCount> table = {};
+        table[CommandFormat::AddFolder] = [](NetworkManager& m, const QCborArray& a) {
+            emit m.addFolder(a.at(1).toString(), a.at(0).toString(), a.at(2).toString(), true);
+        };
+        table[CommandFormat::RemoveFolder] = [](NetworkManager& m, const QCborArray& a) {
+            emit m.removeFolder(a.at(0).toString());
+        };
+        table[CommandFormat::AddEntity] = [](NetworkManager& m, const QCborArray& a) {
+            emit m.addEntity(a.at(1).toString(), a.at(0).toString(), a.at(2).toString(), true);
+        };
+        table[CommandFormat::AddEntityJson] = [](NetworkManager& m, const QCborArray& a) {
+            emit m.addEntityFromJson(a.at(0).toString(), a.at(1).toMap().toJsonObject(), false);
+        };
+        table[CommandFormat::RemoveEntity] = [](NetworkManager& m, const QCborArray& a) {
+            emit m.removeEntity(a.at(1).toString(), a.at(0).toString(), a.at(2).toBool());
+        };
+        table[CommandFormat::AddComponent] = [](NetworkManager& m, const QCborArray& a) {
+            emit m.addComponent(a.at(0).toString(), a.at(1).toString());
+        };
+        table[CommandFormat::UpdateComponent] = [](NetworkManager& m, const QCborArray& a) {
+            emit m.entityComponentUpdate(a.at(0).toString(), a.at(1).toString(), a.at(2).toMap().toJsonObject());
+        };
+        table[CommandFormat::UpdateTracks] = [](NetworkManager& m, const QCborArray& a) {
+            if (!m.hierarchy) return;
+            auto found = m.hierarchy->Entities->find(a.at(0).toString().toStdString());
+            Sensor* sensor = found != m.hierarchy->Entities->end() ? dynamic_cast<Sensor*>(found->second) : nullptr;
+            if (!sensor) return;
+            std::vector<TrackDelta> deltas;
+            const TrackDelta::Kind kinds[] = {TrackDelta::Entered, TrackDelta::Updated, TrackDelta::Lost};
+            for (int k = 0; k < 3; ++k) {
+                for (const QCborValue& value : a.at(k + 1).toArray()) {
+                    const QCborArray track = value.toArray();
+                    deltas.push_back({kinds[k], track.at(1).toBool(), nullptr, track.at(0).toString().toStdString(),
+                                      static_cast<float>(track.at(2).toDouble()), static_cast<float>(track.at(3).toDouble())});
+                }
+            }
+            sensor->applyRemoteDeltas(deltas);
+        };
+        return table;
+    }();
+
+    CommandReader reader(message);
+    quint8 opcode = 0;
+    QCborArray args;
+    while (reader.next(opcode, args)) {
+        if (opcode < CommandFormat::OpcodeCount && handlers[opcode]) handlers[opcode](*this, args);
+    }
+    if (!reader.atEnd()) qWarning() << "[NetworkManager] Malformed command batch";
+    emit updateScene(0.01f);
 }
 
 
@@ -229,38 +282,555 @@ void NetworkManager::toJson() {
         file.close();
     }
 }
+// Every stateTickTimer timeout, at stateTickRate whatever the simulation's
+// frame rate and also while it is paused; a late timeout is one tick, never
+// a burst of them.
 void NetworkManager::UpdateClient(){
-    if(!network->isServer()) return;
-    QJsonObject msg;
-    msg["role"] = "update"; // Corrected typo: "upate" -> "update"
-    msg["type"] = "frame";
+    if((!network->isServer() && !sharedState.isOpen()) || !hierarchy) return;
+    if (!stateClock.isValid()) stateClock.start();
+    sendStateTick();
+}
 
-    QJsonObject delta;
-    for (auto& [key, entity] : *hierarchy->Entities)
-    {
+// Snapshots the platforms, then sends every client the rows that differ
+// from what it acknowledged, limited to its area of interest and, most
+// important first, to its byte budget
+void NetworkManager::sendStateTick(){
+    if (stateTableDirty) rebuildStateTable();
+    sendStateIndex(false);
+    const double serverTime = stateClock.nsecsElapsed() / 1e9;
+    const double tickDelta = stateLastTick >= 0.0 ? serverTime - stateLastTick : 1.0 / stateTickRate;
+    stateLastTick = serverTime;
+
+    std::swap(statePrevious, stateCurrent);
+    EntityStateFormat::EntityState absent = {};
+    absent.index = EntityStateFormat::NoEntity;
+    stateCurrent.sequence = ++stateSequence;
+    stateCurrent.time = serverTime;
+    stateCurrent.rows.assign(stateIndex.size(), absent);
+    for (const StateEntity& entry : stateEntities) {
+        Transform* transform = entry.platform->transform;
+        if (transform) stateCurrent.rows[entry.index] = EntityStateFormat::makeState(entry.index, transform->translation(), transform->rotation());
+    }
+    if (sharedState.isOpen()) {
+        // Indices are never reused, so a bigger table is a changed one
+        if (sharedIndexCount != stateIndex.size()) {
+            sharedIndex = EntityStateFormat::encodeIndex(stateIndexEntries());
+            sharedIndexCount = stateIndex.size();
+            sharedIndexVersion++;
+        }
+        sharedState.publish(stateCurrent, serverTime, sharedIndex, sharedIndexVersion);
+    }
+
+    bool gridBuilt = false;
+    for (auto& [clientId, client] : stateClients) {
+        const EntitySnapshot* baseline = nullptr;
+        if (client.ackedSequence && stateCurrent.sequence - client.ackedSequence <= EntityStateFormat::MaxDeltaAge) {
+            baseline = findSnapshot(client.views, client.ackedSequence);
+        }
+        if (!baseline && !client.resyncing) {
+            qDebug() << "[NetworkManager] Client" << clientId << "last acked" << client.ackedSequence
+                     << ", resyncing with full snapshots";
+        }
+        client.resyncing = !baseline;
+        (baseline ? client.deltaSnapshots : client.fullSnapshots)++;
+
+        if (client.interest.isFiltered()) {
+            if (!gridBuilt && client.interest.shape != InterestArea::Everything) {
+                buildInterestGrid(stateCurrent);
+                gridBuilt = true;
+            }
+            updateInterest(client, stateCurrent);
+        }
+        for (const QByteArray& datagram : encodeClient(client, baseline, tickDelta, serverTime)) {
+            client.bytesSent += datagram.size();
+            network->sendUDPDatagram(clientId, datagram);
+        }
+    }
+}
+
+// Every changed row gains priority each tick it waits, so rows that lose
+// out now win later. The rows sent are also written into the client's view
+// of this tick, which becomes the baseline once the client acks it.
+const std::vector<QByteArray>& NetworkManager::encodeClient(StateClient& client, const EntitySnapshot* baseline,
+                                                            double tickDelta, double serverTime){
+    EntityStateFormat::EntityState absent = {};
+    absent.index = EntityStateFormat::NoEntity;
+    EntitySnapshot view;
+    if (client.views.size() > EntityStateFormat::MaxDeltaAge && baseline != &client.views.front()) {
+        view = std::move(client.views.front()); // reuse the oldest buffer
+        client.views.pop_front();
+    }
+    view.sequence = stateCurrent.sequence;
+    view.time = serverTime;
+    if (baseline) view.rows = baseline->rows;
+    else view.rows.clear();
+    view.rows.resize(stateCurrent.rows.size(), absent);
+    if (client.priority.size() < stateCurrent.rows.size()) client.priority.resize(stateCurrent.rows.size(), 0.0f);
+
+    stateScheduled.clear();
+    auto schedule = [&](quint16 index) {
+        const EntityStateFormat::EntityState& row = stateCurrent.rows[index];
+        if (row.index == EntityStateFormat::NoEntity) return;
+        if (EntityStateFormat::sameState(view.rows[index], row)) {
+            client.priority[index] = 0.0f;
+            return;
+        }
+        client.priority[index] += statePriority(client, index, tickDelta) * static_cast<float>(tickDelta);
+        stateScheduled.push_back(index);
+    };
+    if (client.interest.isFiltered()) {
+        for (quint16 index : client.visible) schedule(index);
+    } else {
+        for (const StateEntity& entry : stateEntities) schedule(entry.index);
+    }
+
+    size_t count = stateScheduled.size();
+    if (stateClientBudget > 0) count = std::min(count, static_cast<size_t>(EntityStateFormat::statesWithin(stateClientBudget)));
+    std::partial_sort(stateScheduled.begin(), stateScheduled.begin() + count, stateScheduled.end(), [&](quint16 a, quint16 b) {
+        return client.priority[a] > client.priority[b];
+    });
+    client.deferredRows += stateScheduled.size() - count;
+
+    stateWriter.begin(stateCurrent.sequence, serverTime, baseline ? baseline->sequence : 0, count < stateScheduled.size());
+    for (size_t i = 0; i < count; ++i) {
+        const quint16 index = stateScheduled[i];
+        stateWriter.add(stateCurrent.rows[index]);
+        view.rows[index] = stateCurrent.rows[index];
+        client.priority[index] = 0.0f;
+    }
+    client.views.push_back(std::move(view));
+    return stateWriter.finish();
+}
+
+// Base 1, more for fast movers, less the further from the client's area,
+// most for what the client has selected
+float NetworkManager::statePriority(const StateClient& client, quint16 index, double tickDelta) const{
+    const QVector3D position = EntityStateFormat::statePosition(stateCurrent.rows[index]);
+    float priority = 1.0f;
+    if (index < statePrevious.rows.size() && statePrevious.rows[index].index != EntityStateFormat::NoEntity && tickDelta > 0.0) {
+        const float moved = (position - EntityStateFormat::statePosition(statePrevious.rows[index])).length();
+        priority += SpeedPriority * moved / static_cast<float>(tickDelta);
+    }
+    if (client.interest.isFiltered() && client.interest.shape != InterestArea::Everything) {
+        const float scale = std::max(1.0f, client.interest.boundsRadius());
+        priority *= scale / (scale + (position - client.interest.boundsCenter()).length());
+    }
+    if (index < client.selected.size() && client.selected[index]) priority *= SelectedPriority;
+    return priority;
+}
+
+// Cells sized to the smallest registered area, so a query touches about
+// 3x3x3 of them
+void NetworkManager::buildInterestGrid(const EntitySnapshot& snapshot){
+    float cellSize = 0.0f;
+    for (const auto& [clientId, client] : stateClients) {
+        if (!client.interest.isFiltered() || client.interest.shape == InterestArea::Everything) continue;
+        const float size = client.interest.boundsRadius();
+        if (cellSize == 0.0f || size < cellSize) cellSize = size;
+    }
+    interestGrid.setCellSize(cellSize);
+    interestGrid.clear();
+    for (const StateEntity& entry : stateEntities) {
+        const EntityStateFormat::EntityState& row = snapshot.rows[entry.index];
+        if (row.index != EntityStateFormat::NoEntity) interestGrid.insert(entry.platform, EntityStateFormat::statePosition(row));
+    }
+}
+
+// Only the grid cells around the area and the entities visible last tick
+// are looked at, so the cost follows what the client sees
+void NetworkManager::updateInterest(StateClient& client, const EntitySnapshot& snapshot){
+    const InterestArea& area = client.interest;
+    if (client.visibleSince.size() < snapshot.rows.size()) client.visibleSince.resize(snapshot.rows.size(), 0);
+    if (interestStamp.size() < snapshot.rows.size()) interestStamp.resize(snapshot.rows.size(), 0);
+    if (++interestPass == 0) {
+        std::fill(interestStamp.begin(), interestStamp.end(), 0);
+        interestPass = 1;
+    }
+
+    interestNext.clear();
+    auto consider = [&](const StateEntity& entry) {
+        const EntityStateFormat::EntityState& row = snapshot.rows[entry.index];
+        if (row.index == EntityStateFormat::NoEntity || !(area.typeMask & entry.typeBit)) return;
+        if (!area.sides.empty() && (entry.side >= client.allowedSides.size() || !client.allowedSides[entry.side])) return;
+        quint32& since = client.visibleSince[entry.index];
+        if (!area.contains(EntityStateFormat::statePosition(row), since ? area.margin : 0.0f)) return;
+        if (!since) since = snapshot.sequence;
+        interestStamp[entry.index] = interestPass;
+        interestNext.push_back(entry.index);
+    };
+    if (area.shape == InterestArea::Everything) {
+        for (const StateEntity& entry : stateEntities) consider(entry);
+    } else {
+        interestCandidates.clear();
+        interestGrid.query(area.boundsCenter(), area.boundsRadius(), interestCandidates);
+        for (Platform* platform : interestCandidates) {
+            auto it = statePlatforms.find(platform);
+            if (it != statePlatforms.end()) consider(stateEntities[it->second]);
+        }
+    }
+    for (quint16 index : client.visible) {
+        if (interestStamp[index] != interestPass) client.visibleSince[index] = 0;
+    }
+    client.visible.swap(interestNext);
+}
+
+void NetworkManager::setClientInterest(StateClient& client, InterestArea area){
+    if (!area.isFiltered()) {
+        client.visible.clear();
+        client.visibleSince.clear();
+    }
+    client.allowedSides.clear();
+    for (const std::string& side : area.sides) {
+        const quint16 id = stateSides.emplace(side, static_cast<quint16>(stateSides.size())).first->second;
+        if (id >= client.allowedSides.size()) client.allowedSides.resize(id + 1, false);
+        client.allowedSides[id] = true;
+    }
+    client.interest = std::move(area);
+}
+
+// Selected IDs without a wire index yet are resolved again when one is added
+void NetworkManager::resolveSelection(StateClient& client){
+    client.selected.assign(stateIndex.size(), false);
+    for (const std::string& id : client.selection) {
+        auto it = stateIndex.find(id);
+        if (it != stateIndex.end()) client.selected[it->second] = true;
+    }
+}
+
+const EntitySnapshot* NetworkManager::findSnapshot(const std::deque<EntitySnapshot>& history, quint32 sequence){
+    for (auto it = history.rbegin(); it != history.rend(); ++it) {
+        if (it->sequence == sequence) return &*it;
+    }
+    return nullptr;
+}
+
+void NetworkManager::onClientConnected(quint32 clientId){
+    stateClients[clientId] = StateClient();
+}
+
+void NetworkManager::onClientMessage(quint32 clientId, QString message){
+    if(message.contains("give me")) beginWorldSync(clientId);
+}
+
+void NetworkManager::onClientDisconnected(quint32 clientId){
+    worldSyncs.erase(clientId);
+    auto it = stateClients.find(clientId);
+    if (it == stateClients.end()) return;
+    qDebug() << "[NetworkManager] Client" << clientId << "left after" << it->second.fullSnapshots << "full and"
+             << it->second.deltaSnapshots << "delta snapshots," << it->second.bytesSent << "bytes,"
+             << it->second.deferredRows << "rows deferred";
+    stateClients.erase(it);
+}
+
+void NetworkManager::onClientBinaryMessage(quint32 clientId, QByteArray message){
+    auto it = stateClients.find(clientId);
+    if (it == stateClients.end()) return;
+    StateClient& client = it->second;
+    // Dispatched on the magic so one kind never goes through another's decoder
+    auto hasMagic = [&message](const char (&magic)[2]) {
+        return message.size() >= 2 && std::memcmp(message.constData(), magic, sizeof(magic)) == 0;
+    };
+    if (hasMagic(EntityStateFormat::InterestMagic)) {
+        InterestArea area;
+        if (InterestArea::decode(message, area)) setClientInterest(client, std::move(area));
+        return;
+    }
+    if (hasMagic(EntityStateFormat::SelectionMagic)) {
+        if (EntityStateFormat::decodeSelection(message, client.selection)) resolveSelection(client);
+        return;
+    }
+    quint32 sequence = 0;
+    if (!hasMagic(EntityStateFormat::AckMagic) || !EntityStateFormat::decodeAck(message, sequence)) return;
+    // Acks can overtake each other only across reconnects; keep the newest
+    if (!client.ackedSequence || static_cast<qint32>(sequence - client.ackedSequence) > 0) {
+        client.ackedSequence = sequence;
+        if (const EntitySnapshot* view = findSnapshot(client.views, sequence)) {
+            const double roundTrip = stateClock.nsecsElapsed() / 1e9 - view->time;
+            client.roundTrip = client.roundTrip < 0.0 ? roundTrip : client.roundTrip + (roundTrip - client.roundTrip) * 0.1;
+        }
+    }
+}
+
+// Queue figures come from the I/O thread, the round trip from acks
+void NetworkManager::onClientMetrics(QVector<ClientMetrics> metrics){
+    for (ClientMetrics& entry : metrics) {
+        auto it = stateClients.find(entry.clientId);
+        if (it != stateClients.end()) entry.roundTrip = it->second.roundTrip;
+        if (entry.oldestMessageAge > 1.0) {
+            qDebug() << "[NetworkManager] Client" << entry.clientId << entry.address << "is" << entry.oldestMessageAge
+                     << "s behind," << entry.queuedBytes << "bytes queued";
+        }
+    }
+    emit clientMetrics(metrics);
+}
+
+// The only place entities are dynamic_cast; runs after the entity set changed
+void NetworkManager::rebuildStateTable(){
+    const size_t indexed = stateIndex.size();
+    stateEntities.clear();
+    statePlatforms.clear();
+    for (auto& [key, entity] : *hierarchy->Entities) {
         Platform* platform = dynamic_cast<Platform*>(entity);
-        if (platform) {
-            QVector3D pos = platform->transform->translation();
+        if (!platform) continue;
+        auto it = stateIndex.find(key);
+        if (it == stateIndex.end()) {
+            if (stateIndex.size() >= EntityStateFormat::NoEntity) {
+                qWarning() << "[NetworkManager] State index full, not streaming" << QString::fromStdString(key);
+                continue;
+            }
+            it = stateIndex.emplace(key, static_cast<quint16>(stateIndex.size())).first;
+            newStateIndex.emplace_back(it->second, key);
+        }
+        const unsigned type = static_cast<unsigned>(platform->type);
+        const std::string side = platform->customParameters.value("side").toString().toStdString();
+        const quint16 sideId = stateSides.emplace(side, static_cast<quint16>(stateSides.size())).first->second;
+        statePlatforms[platform] = stateEntities.size();
+        stateEntities.push_back({platform, it->second, 1u << (type < 32 ? type : unsigned(Constants::Platform)), sideId});
+    }
+    stateTableDirty = false;
+    if (stateIndex.size() == indexed) return;
+    for (auto& [clientId, client] : stateClients) {
+        if (!client.selection.empty()) resolveSelection(client);
+    }
+}
+
+void NetworkManager::sendStateIndex(bool full){
+    if(!network->isServer() || !hierarchy) return;
+    if (stateTableDirty) rebuildStateTable();
+    if (full) newStateIndex = stateIndexEntries();
+    if (newStateIndex.empty()) return;
+    network->sendBinaryMessage(EntityStateFormat::encodeIndex(newStateIndex));
+    newStateIndex.clear();
+}
+
+std::vector<std::pair<quint16, std::string>> NetworkManager::stateIndexEntries() const{
+    std::vector<std::pair<quint16, std::string>> entries;
+    entries.reserve(stateIndex.size());
+    for (const auto& [id, index] : stateIndex) entries.emplace_back(index, id);
+    return entries;
+}
+
+// Captures every profile now; sendWorldSync streams them afterwards
+void NetworkManager::beginWorldSync(quint32 clientId){
+    if(!network->isServer() || !hierarchy) return;
+    flushCommands(); // the capture includes them, so they must reach the client before it
+    WorldSync& sync = worldSyncs[clientId];
+    sync = WorldSync();
+    sync.id = ++worldSyncCounter;
+    std::vector<WorldSyncFormat::ProfileEntry> entries;
+    qint64 total = 0;
+    for (const auto& [id, profile] : hierarchy->ProfileCategories) {
+        if (!profile) continue;
+        sync.profiles.push_back(WorldSyncFormat::packProfile(profile->toJson()));
+        entries.push_back({id, static_cast<quint32>(sync.profiles.back().size())});
+        total += sync.profiles.back().size();
+    }
+    network->sendBinaryMessage(clientId, WorldSyncFormat::encodeBegin(sync.id, entries));
+    // The whole index, so the client can resolve every row once the profiles are in
+    if (stateTableDirty) rebuildStateTable();
+    network->sendBinaryMessage(clientId, EntityStateFormat::encodeIndex(stateIndexEntries()));
+    qDebug() << "[NetworkManager] World sync" << sync.id << "to client" << clientId << ":" << entries.size()
+             << "profiles," << total << "bytes packed";
+    sendWorldSync();
+    if (!worldSyncs.empty()) worldSyncTimer->start();
+}
+
+// Paced by each client's reliable queue, so a big world neither piles up
+// in memory nor delays the changes queued behind it for long
+void NetworkManager::sendWorldSync(){
+    for (auto it = worldSyncs.begin(); it != worldSyncs.end();) {
+        const quint32 clientId = it->first;
+        WorldSync& sync = it->second;
+        while (sync.profile < sync.profiles.size() && network->queuedBytes(clientId) < SyncQueueLimit) {
+            QByteArray& packed = sync.profiles[sync.profile];
+            const int length = std::min(WorldSyncFormat::ChunkSize, packed.size() - sync.offset);
+            network->sendBinaryMessage(clientId, WorldSyncFormat::encodeChunk(sync.id, static_cast<quint32>(sync.profile),
+                                                                              static_cast<quint32>(sync.offset),
+                                                                              packed.constData() + sync.offset, length));
+            sync.offset += length;
+            if (sync.offset >= packed.size()) {
+                packed = QByteArray();
+                sync.profile++;
+                sync.offset = 0;
+            }
+        }
+        if (sync.profile < sync.profiles.size()) {
+            ++it;
+            continue;
+        }
+        network->sendBinaryMessage(clientId, WorldSyncFormat::encodeEnd(sync.id));
+        it = worldSyncs.erase(it);
+    }
+    if (worldSyncs.empty()) worldSyncTimer->stop();
+}
+
+// Client side of the sync: each profile replaces the local one as soon as
+// it is complete; state rows for its platforms resolve from then on
+bool NetworkManager::applyWorldSync(const QByteArray& message){
+    WorldSyncFormat::ChunkHeader chunk;
+    const char* data = nullptr;
+    int length = 0;
+    if (WorldSyncFormat::decodeChunk(message, chunk, data, length)) {
+        if (!syncing || chunk.syncId != syncId || chunk.profile >= syncPacked.size()) return true;
+        QByteArray& packed = syncPacked[chunk.profile];
+        if (chunk.offset != static_cast<quint32>(packed.size())) {
+            qWarning() << "[NetworkManager] World sync chunk at" << chunk.offset << "expected" << packed.size();
+            return true;
+        }
+        packed.append(data, length);
+        syncReceived += length;
+        if (static_cast<quint32>(packed.size()) >= syncProfiles[chunk.profile].packedSize) {
+            QJsonObject profile;
+            if (WorldSyncFormat::unpackProfile(packed, profile)) {
+                emit initProfile(profile);
+                stateTargetsDirty = true;
+            } else {
+                qWarning() << "[NetworkManager] Could not unpack profile" << QString::fromStdString(syncProfiles[chunk.profile].id);
+            }
+            packed = QByteArray();
+        }
+        emit worldSyncProgress(syncReceived, syncTotal);
+        return true;
+    }
+
+    quint32 id = 0;
+    std::vector<WorldSyncFormat::ProfileEntry> profiles;
+    if (WorldSyncFormat::decodeBegin(message, id, profiles)) {
+        syncing = true;
+        syncId = id;
+        syncProfiles = std::move(profiles);
+        syncPacked.assign(syncProfiles.size(), QByteArray());
+        syncReceived = syncTotal = 0;
+        syncDeferred.clear();
+        QStringList ids;
+        for (const WorldSyncFormat::ProfileEntry& profile : syncProfiles) {
+            syncTotal += profile.packedSize;
+            ids.append(QString::fromStdString(profile.id));
+        }
+        emit retainProfiles(ids);
+        stateTargetsDirty = true;
+        emit worldSyncProgress(0, syncTotal);
+        return true;
+    }
+    if (WorldSyncFormat::decodeEnd(message, id)) {
+        if (!syncing || id != syncId) return true;
+        syncing = false;
+        syncProfiles.clear();
+        syncPacked.clear();
+        std::vector<QByteArray> deferred;
+        deferred.swap(syncDeferred);
+        qDebug() << "[NetworkManager] World sync" << id << "done," << syncTotal << "bytes," << deferred.size() << "batches replayed";
+        for (const QByteArray& batch : deferred) applyCommands(batch);
+        emit worldSyncProgress(syncTotal, syncTotal);
+        return true;
+    }
+    return false;
+}
+
+void NetworkManager::onBinaryMessage(QByteArray message){
+    if (applyWorldSync(message)) return;
+    if (CommandFormat::isBatchMessage(message)) {
+        applyCommands(message);
+        return;
+    }
+    std::vector<std::pair<quint16, std::string>> entries;
+    if (!EntityStateFormat::decodeIndex(message, entries)) return;
+    for (const auto& [index, id] : entries) {
+        if (index >= stateIds.size()) stateIds.resize(index + 1);
+        stateIds[index] = id;
+    }
+    stateTargetsDirty = true;
+}
+
+void NetworkManager::resolveStateTargets(){
+    stateTargets.assign(stateIds.size(), nullptr);
+    for (size_t i = 0; i < stateIds.size(); ++i) {
+        auto it = hierarchy->Entities->find(stateIds[i]);
+        if (it != hierarchy->Entities->end()) stateTargets[i] = dynamic_cast<Platform*>(it->second);
+    }
+    stateTargetsDirty = false;
+}
 
-            // --- FIX: Use QJsonArray for the position coordinates ---
-            QJsonArray positionArray;
-            positionArray.append(pos.x());
-            positionArray.append(pos.y());
-            positionArray.append(pos.z());
-            positionArray.append(platform->transform->toEulerAngles().y());
+// Rows are read straight out of the datagram into the interpolator, which
+// renderStates shows a little behind the server; parts of an older tick that
+// arrive late are dropped. A snapshot is acked once all its parts are in and
+// becomes a baseline.
+void NetworkManager::onStateDatagram(QByteArray datagram){
+    EntityStateView view(datagram);
+    if (!view.isValid() || !hierarchy || network->isServer()) return;
+    if (hasStateSequence && static_cast<qint32>(view.sequence() - buildingSnapshot.sequence) < 0) return;
+    if (!renderClock.isValid()) renderClock.start();
+    if (!hasStateSequence || view.sequence() != buildingSnapshot.sequence) {
+        beginStateSnapshot(view);
+        stateInterpolator.addTick(view.serverTime(), renderClock.nsecsElapsed() / 1e9);
+    }
+    hasStateSequence = true;
+    if (view.part() >= static_cast<int>(buildingParts.size()) || buildingParts[view.part()]) return; // duplicate
+    buildingParts[view.part()] = true;
+    buildingPartsLeft--;
+    if (!renderTimer->isActive()) renderTimer->start();
+
+    for (int i = 0; i < view.count(); ++i) {
+        const EntityStateFormat::EntityState state = view.state(i);
+        if (buildingUsable) {
+            if (state.index >= buildingSnapshot.rows.size()) {
+                EntityStateFormat::EntityState absent = {};
+                absent.index = EntityStateFormat::NoEntity;
+                buildingSnapshot.rows.resize(state.index + 1, absent);
+            }
+            buildingSnapshot.rows[state.index] = state;
+        }
+        stateInterpolator.addSample(state.index, view.serverTime(), state);
+    }
+    if (buildingPartsLeft == 0 && buildingUsable) completeStateSnapshot();
+}
+
+void NetworkManager::beginStateSnapshot(const EntityStateView& view){
+    buildingSnapshot.sequence = view.sequence();
+    buildingTime = view.serverTime();
+    buildingDeferred = view.isDeferred();
+    buildingParts.assign(view.partCount(), false);
+    buildingPartsLeft = view.partCount();
+    buildingUsable = true;
+    if (!view.isDelta()) {
+        buildingSnapshot.rows.clear();
+        return;
+    }
+    const EntitySnapshot* baseline = findSnapshot(receivedSnapshots, view.baseline());
+    buildingUsable = baseline != nullptr;
+    if (baseline) buildingSnapshot.rows = baseline->rows;
+}
 
-            delta[QString::fromStdString(key)] = positionArray;
+void NetworkManager::completeStateSnapshot(){
+    // Rows the delta skipped did not move; without a sample at this tick too
+    // they would be extrapolated along their last velocity. When the server
+    // deferred rows, a skipped one may just be waiting and keeps its motion.
+    if (!buildingDeferred) {
+        for (const EntityStateFormat::EntityState& row : buildingSnapshot.rows) {
+            if (row.index != EntityStateFormat::NoEntity) stateInterpolator.holdSample(row.index, buildingTime, row);
         }
     }
-    msg["delta"] = delta;
-    QJsonDocument doc(msg);
-    QString msgs = doc.toJson(QJsonDocument::Compact);
-    std::string stdMsg = msgs.toStdString();
-    std::cout << "Log: " << stdMsg << std::endl;
-    //qDebug() << "[NetworkManager JSON] Sending:" << &stdMsg;
-    network->sendUDPMessage(msgs);
+    if (receivedSnapshots.size() >= static_cast<size_t>(EntityStateFormat::SnapshotHistory)) receivedSnapshots.pop_front();
+    receivedSnapshots.push_back(buildingSnapshot);
+    network->sendBinaryMessage(EntityStateFormat::encodeAck(buildingSnapshot.sequence));
+}
 
-    //emit this->getCurrentJsonData();
+// Every frame, not every tick: platforms move between ticks even at a low
+// send rate, and entities created after their state arrived catch up here
+void NetworkManager::renderStates(){
+    if (!hierarchy || network->isServer()) return;
+    if (stateTargetsDirty) resolveStateTargets();
+    const double time = stateInterpolator.renderTime(renderClock.nsecsElapsed() / 1e9);
+    QVector3D position;
+    QQuaternion orientation;
+    for (size_t i = 0; i < stateTargets.size(); ++i) {
+        Platform* platform = stateTargets[i];
+        if (!platform || !platform->transform) continue;
+        if (!stateInterpolator.evaluate(static_cast<quint16>(i), time, position, orientation)) continue;
+        platform->transform->setTranslation(position);
+        platform->transform->setRotation(orientation);
+    }
+    emit updateScene(1.0f / RenderRate);
 }
 
 void NetworkManager::fromJson() {
@@ -278,173 +848,99 @@ void NetworkManager::fromJson() {
 void NetworkManager::profileAddedPointer(ProfileCategaory*) {}
 void NetworkManager::folderAddedPointer(QString parentID, Folder*) {}
 void NetworkManager::entityAddedPointer(QString parentID, Entity* entity) {
-    QJsonObject msg = entity->toJson();
-    msg["role"] = "add";
-    msg["type"] = "entityJson";
-    msg["parentID"] = parentID;
-    sendJson(msg);
+    stateTableDirty = stateTargetsDirty = true;
+    queueCommand(CommandFormat::AddEntityJson, {parentID, QCborMap::fromJsonObject(entity->toJson())});
 }
 
 void NetworkManager::profileAdded(QString ID, QString profileName) {
-    QJsonObject msg;
-    msg["role"] = "add";
-    msg["type"] = "profile";
-    msg["id"] = ID;
-    msg["name"] = profileName;
-    sendJson(msg);
-    //emit this->getCurrentJsonData();
+    queueCommand(CommandFormat::AddProfile, {ID, profileName});
 }
 
 void NetworkManager::folderAdded(QString parentID, QString ID, QString folderName) {
-    QJsonObject msg;
-    msg["role"] = "add";
-    msg["type"] = "folder";
-    msg["id"] = ID;
-    msg["parentID"] = parentID;
-    msg["name"] = folderName;
-    sendJson(msg);
-    //emit this->getCurrentJsonData();
+    queueCommand(CommandFormat::AddFolder, {ID, parentID, folderName});
 }
 
 void NetworkManager::entityAdded(QString parentID, QString ID, QString entityName) {
-    QJsonObject msg;
-    msg["role"] = "add";
-    msg["type"] = "entity";
-    msg["id"] = ID;
-    msg["parentID"] = parentID;
-    msg["name"] = entityName;
-    sendJson(msg);
-    //emit this->getCurrentJsonData();
+    stateTableDirty = stateTargetsDirty = true;
+    queueCommand(CommandFormat::AddEntity, {ID, parentID, entityName});
 }
 
 void NetworkManager::componentAdded(QString Id, QString componentName) {
-    QJsonObject msg;
-    msg["role"] = "add";
-    msg["type"] = "component";
-    msg["id"] = Id;
-    msg["name"] = componentName;
-    sendJson(msg);
-    //emit this->getCurrentJsonData();
+    queueCommand(CommandFormat::AddComponent, {Id, componentName});
+}
+
+// One command per sensor per tick carrying only its changed tracks
+void NetworkManager::sensorTracksChanged(Sensor* sensor, const std::vector<TrackDelta>& deltas)
+{
+    if(!network->isServer()) return;
+    QCborArray entered, updated, lost;
+    for (const TrackDelta& delta : deltas) {
+        QCborArray track;
+        track.append(QString::fromStdString(delta.targetId));
+        track.append(delta.ew);
+        if (delta.kind == TrackDelta::Lost) {
+            lost.append(track);
+            continue;
+        }
+        track.append(delta.angle);
+        track.append(delta.radius);
+        (delta.kind == TrackDelta::Entered ? entered : updated).append(track);
+    }
+    queueCommand(CommandFormat::UpdateTracks, {QString::fromStdString(sensor->ID), entered, updated, lost});
 }
 
 void NetworkManager::entityComponentsUpdate(QString ID, QString componentName, QJsonObject delta)
 {
-    QJsonObject msg;
-    msg["role"] = "update";
-    msg["type"] = "component";
-    msg["id"] = ID;
-    msg["delta"] = delta;
-    msg["name"] = componentName;
-    sendJson(msg);
+    queueCommand(CommandFormat::UpdateComponent, {ID, componentName, QCborMap::fromJsonObject(delta)});
 }
 
 void NetworkManager::profileRemoved(QString ID) {
-    QJsonObject msg;
-    msg["role"] = "remove";
-    msg["type"] = "profile";
-    msg["id"] = ID;
-    sendJson(msg);
-    //emit this->getCurrentJsonData();
+    queueCommand(CommandFormat::RemoveProfile, {ID});
 }
 
 void NetworkManager::folderRemoved(QString ID) {
-    QJsonObject msg;
-    msg["role"] = "remove";
-    msg["type"] = "folder";
-    msg["id"] = ID;
-    sendJson(msg);
-    //emit this->getCurrentJsonData();
+    queueCommand(CommandFormat::RemoveFolder, {ID});
 }
 
 void NetworkManager::entityRemoved(QString parentId,QString ID,bool Profile) {
-    QJsonObject msg;
-    msg["role"] = "remove";
-    msg["type"] = "entity";
-    msg["id"] = ID;
-    msg["parentId"] = parentId;
-    msg["Profile"] = Profile;
-    sendJson(msg);
-    //emit this->getCurrentJsonData();
+    stateTableDirty = stateTargetsDirty = true;
+    queueCommand(CommandFormat::RemoveEntity, {ID, parentId, Profile});
 }
 
 void NetworkManager::componentRemoved(QString parentID, QString componentName) {
-    QJsonObject msg;
-    msg["role"] = "remove";
-    msg["type"] = "component";
-    msg["parentID"] = parentID;
-    msg["name"] = componentName;
-    sendJson(msg);
-    //emit this->getCurrentJsonData();
+    queueCommand(CommandFormat::RemoveComponent, {parentID, componentName});
 }
 
 void NetworkManager::profileRenamed(QString ID, QString name) {
-    QJsonObject msg;
-    msg["role"] = "rename";
-    msg["type"] = "profile";
-    msg["id"] = ID;
-    msg["newName"] = name;
-    sendJson(msg);
-    //emit this->getCurrentJsonData();
+    queueCommand(CommandFormat::RenameProfile, {ID, name});
 }
 
 void NetworkManager::folderRenamed(QString ID, QString name) {
-    QJsonObject msg;
-    msg["role"] = "rename";
-    msg["type"] = "folder";
-    msg["id"] = ID;
-    msg["newName"] = name;
-    //sendJson(msg);
-    //emit this->getCurrentJsonData();
+    //queueCommand(CommandFormat::RenameFolder, {ID, name});
 }
 
 void NetworkManager::entityRenamed(QString ID, QString name) {
-    QJsonObject msg;
-    msg["role"] = "rename";
-    msg["type"] = "entity";
-    msg["id"] = ID;
-    msg["newName"] = name;
-    sendJson(msg);
-    //emit this->getCurrentJsonData();
+    queueCommand(CommandFormat::RenameEntity, {ID, name});
 }
 
 void NetworkManager::entityMeshAdded(QString ID, Entity*) {
-    QJsonObject msg;
-    msg["role"] = "add";
-    msg["type"] = "mesh";
-    msg["entityID"] = ID;
-    sendJson(msg);
+    queueCommand(CommandFormat::AddMesh, {ID});
 }
 
 void NetworkManager::entityMeshRemoved(QString ID) {
-    QJsonObject msg;
-    msg["role"] = "remove";
-    msg["type"] = "mesh";
-    msg["entityID"] = ID;
-    sendJson(msg);
+    queueCommand(CommandFormat::RemoveMesh, {ID});
 }
 
 void NetworkManager::entityPhysicsAdded(QString ID, Entity*) {
-    QJsonObject msg;
-    msg["role"] = "add";
-    msg["type"] = "physics";
-    msg["entityID"] = ID;
-    sendJson(msg);
+    stateTableDirty = stateTargetsDirty = true;
+    queueCommand(CommandFormat::AddPhysics, {ID});
 }
 
 void NetworkManager::entityPhysicsRemoved(QString ID) {
-    QJsonObject msg;
-    msg["role"] = "remove";
-    msg["type"] = "physics";
-    msg["entityID"] = ID;
-    sendJson(msg);
+    stateTableDirty = stateTargetsDirty = true;
+    queueCommand(CommandFormat::RemovePhysics, {ID});
 }
 
 void NetworkManager::entityUpdate(QString ID) {
-    QJsonObject msg;
-    msg["role"] = "update";
-    msg["type"] = "entity";
-    msg["id"] = ID;
-    sendJson(msg);
-    //emit this->getCurrentJsonData();
+    queueCommand(CommandFormat::UpdateEntity, {ID});
 }
-
@@ -8,7 +8,19 @@
 
 #include "core/Hierarchy/profilecategaory.h"
 #include "core/Network/networktransport.h"
+#include "core/Network/entitystate.h"
+#include "core/Network/stateinterpolator.h"
+#include "core/Network/sharedstate.h"
+#include "core/Network/worldsync.h"
+#include "core/Network/command.h"
+#include "core/Hierarchy/Utils/spatialgrid.h"
+#include <QElapsedTimer>
+#include <QTimer>
+#include <deque>
+#include <algorithm>
+#include <array>
 #include <core/Hierarchy/hierarchy.h> // <-- Add or confirm this line
+#include <core/Hierarchy/EntityProfiles/sensor.h>
 // or whatever the correct path is, e.g., #include "hierarchy.h"
 class NetworkManager : public QObject {
     Q_OBJECT
@@ -29,9 +41,35 @@ public:
     bool initClient(const QString& ip, int port); // << updated
     bool startClient();                           // << now uses stored IP/port
     bool stopClient();
+    // Stream only what is inside area; kept and sent again on every connect
+    void setInterest(const InterestArea& area);
+    void clearInterest() { setInterest(InterestArea()); }
+    // How far entities are shown behind the server, 0 adapts to the send rate
+    void setInterpolationDelay(double seconds) { stateInterpolator.setInterpolationDelay(seconds); }
+    // Entities the user selected; the server sends them more often
+    void setSelection(const std::vector<std::string>& ids);
+
+    // Server: state ticks per second, on a timer of their own
+    void setNetworkTickRate(int ticksPerSecond);
+    int networkTickRate() const { return stateTickRate; }
+    // Server: datagram bytes per client per tick, 0 for no limit
+    void setClientByteBudget(int bytes) { stateClientBudget = std::max(0, bytes); }
+    int clientByteBudget() const { return stateClientBudget; }
+    // Also publish every state tick to local readers (see sharedstate.h);
+    // startServer does this under SharedStateFormat::keyForPort
+    bool publishSharedState(const QString& key);
+    void stopSharedState() { sharedState.close(); }
 
     void onMessaageRecevied(QString message);
+    void onBinaryMessage(QByteArray message);
+    void onStateDatagram(QByteArray datagram);
+    void onClientConnected(quint32 clientId);
+    void onClientDisconnected(quint32 clientId);
+    void onClientMessage(quint32 clientId, QString message);
+    void onClientBinaryMessage(quint32 clientId, QByteArray message);
+    void onClientMetrics(QVector<ClientMetrics> metrics);
     void onConnect();
+    void onDisconnect();
     void onNewConnction();
     // Global network access
     NetworkTransport* networkTransport;
@@ -42,6 +80,7 @@ public:
     void fromJson();
 
     void UpdateClient();
+    void sensorTracksChanged(Sensor* sensor, const std::vector<TrackDelta>& deltas);
     // Entity signals - pointer-based
     void profileAddedPointer(ProfileCategaory* profile);
     void folderAddedPointer(QString parentID, Folder* folder);
@@ -80,7 +119,14 @@ signals:
     void entityComponentUpdate(QString ID, QString name, QJsonObject delta);
     void getCurrentJsonData();
     void initData(const QJsonObject& obj);
+    // Client, during the world sync: one profile to replace, and the
+    // profiles the server has, emitted before any of them arrives
+    void initProfile(const QJsonObject& obj);
+    void retainProfiles(const QStringList& ids);
+    void worldSyncProgress(qint64 receivedBytes, qint64 totalBytes);
     void updateScene(float deltaTime);
+    // Server, about once a second: send queues and round trip per client
+    void clientMetrics(QVector<ClientMetrics> metrics);
 private:
     // static std::unique_ptr<Server> ser;
     // static std::unique_ptr<Client> cli;
@@ -93,6 +139,131 @@ private:
     void sendJson(const QJsonObject& obj);
     NetworkTransport* network;
     Hierarchy* hierarchy = nullptr;
+
+    // Scene changes as binary command batches (see command.h)
+    void queueCommand(CommandFormat::Opcode opcode, const QCborArray& args);
+    void flushCommands();
+    void applyCommands(const QByteArray& message);
+    CommandWriter commandWriter;
+    bool commandFlushPending = false;
+
+    // Binary entity state stream (see entitystate.h)
+    struct StateEntity {
+        Platform* platform;
+        quint16 index;
+        quint32 typeBit; // 1 << Constants::EntityType
+        quint16 side;    // into stateSides
+    };
+    struct StateClient {
+        quint32 ackedSequence = 0; // 0 until the first complete snapshot is acked
+        bool resyncing = true;
+        quint64 fullSnapshots = 0;
+        quint64 deltaSnapshots = 0;
+        quint64 bytesSent = 0;
+        quint64 deferredRows = 0;
+        double roundTrip = -1.0;           // mean seconds from a tick to its ack
+        std::deque<EntitySnapshot> views;  // what the client holds after each recent tick
+        std::vector<float> priority;       // by wire index, grows while a changed row waits
+        std::vector<std::string> selection;
+        std::vector<bool> selected;        // by wire index
+        // Area of interest, only used when interest.isFiltered()
+        InterestArea interest;
+        std::vector<bool> allowedSides;   // by side ID
+        std::vector<quint32> visibleSince; // by wire index, tick it last entered, 0 outside
+        std::vector<quint16> visible;      // wire indices streamed this tick
+    };
+    void rebuildStateTable();
+    void sendStateIndex(bool full);
+    void resolveStateTargets();
+    void sendStateTick();
+    const std::vector<QByteArray>& encodeClient(StateClient& client, const EntitySnapshot* baseline, double tickDelta, double serverTime);
+    float statePriority(const StateClient& client, quint16 index, double tickDelta) const;
+    void setClientInterest(StateClient& client, InterestArea area);
+    void resolveSelection(StateClient& client);
+    void buildInterestGrid(const EntitySnapshot& snapshot);
+    void updateInterest(StateClient& client, const EntitySnapshot& snapshot);
+    void beginStateSnapshot(const EntityStateView& view);
+    void completeStateSnapshot();
+    void resetStateStream();
+    void renderStates();
+    static const EntitySnapshot* findSnapshot(const std::deque<EntitySnapshot>& history, quint32 sequence);
+    std::vector<std::pair<quint16, std::string>> stateIndexEntries() const;
+    void beginWorldSync(quint32 clientId);
+    void sendWorldSync();
+    bool applyWorldSync(const QByteArray& message);
+
+    // Server: platforms streamed each tick, rebuilt only when the entity set changes
+    std::vector<StateEntity> stateEntities;
+    std::unordered_map<std::string, quint16> stateIndex; // entity ID -> wire index, never reused
+    std::vector<std::pair<quint16, std::string>> newStateIndex; // not yet announced
+    bool stateTableDirty = true;
+    quint32 stateSequence = 0;
+    QElapsedTimer stateClock;
+    EntityStateWriter stateWriter;
+    SharedStateWriter sharedState;
+    QByteArray sharedIndex;          // encodeIndex of all of stateIndex
+    quint32 sharedIndexVersion = 0;
+    size_t sharedIndexCount = 0;
+    EntitySnapshot stateCurrent, statePrevious; // this and the last network tick, for speeds
+    std::unordered_map<quint32, StateClient> stateClients;
+    std::vector<quint16> stateScheduled;                     // changed rows of one client, scratch
+
+    // Scheduler: stateTickTimer, independent of simulation and UI rates
+    static const int DefaultTickRate = 20;
+    static const int DefaultClientBudget = 16 * EntityStateFormat::MaxDatagram;
+    static constexpr float SpeedPriority = 0.1f;     // added per m/s to a base of 1
+    static constexpr float SelectedPriority = 10.0f; // factor for selected entities
+    int stateTickRate = DefaultTickRate;
+    int stateClientBudget = DefaultClientBudget;
+    QTimer* stateTickTimer = nullptr;
+    double stateLastTick = -1.0;
+    std::unordered_map<Platform*, size_t> statePlatforms;   // platform -> stateEntities position
+    std::unordered_map<std::string, quint16> stateSides;     // side name -> ID, never reused
+    SpatialGrid interestGrid;                                 // streamed positions, rebuilt per tick when needed
+    std::vector<Platform*> interestCandidates;
+    std::vector<quint16> interestNext;
+    std::vector<quint32> interestStamp;                      // by wire index, last pass that kept it
+    quint32 interestPass = 0;
+
+    // Client: wire index -> entity ID, resolved to platforms when either side changes
+    std::vector<std::string> stateIds;
+    std::vector<Platform*> stateTargets;
+    bool stateTargetsDirty = true;
+    std::deque<EntitySnapshot> receivedSnapshots; // complete and acked, newest at the back
+    EntitySnapshot buildingSnapshot;              // tick whose parts are arriving
+    std::vector<bool> buildingParts;
+    int buildingPartsLeft = 0;
+    bool buildingUsable = false;                  // false when the delta's baseline is unknown
+    double buildingTime = 0.0;
+    bool buildingDeferred = false;
+    bool hasStateSequence = false;
+    StateInterpolator stateInterpolator;
+    QTimer* renderTimer = nullptr;                // moves platforms at RenderRate between ticks
+    QElapsedTimer renderClock;
+    static const int RenderRate = 60;
+    InterestArea clientInterest;
+    std::vector<std::string> clientSelection;
+
+    // Server: initial world for joining clients (see worldsync.h)
+    struct WorldSync {
+        quint32 id = 0;
+        std::vector<QByteArray> profiles; // packed when the sync began
+        size_t profile = 0;               // being sent
+        int offset = 0;
+    };
+    static const int SyncQueueLimit = 1024 * 1024; // reliable bytes queued for a client before its sync waits
+    std::unordered_map<quint32, WorldSync> worldSyncs;
+    quint32 worldSyncCounter = 0;
+    QTimer* worldSyncTimer = nullptr;
+
+    // Client: the sync being received
+    bool syncing = false;
+    quint32 syncId = 0;
+    std::vector<WorldSyncFormat::ProfileEntry> syncProfiles;
+    std::vector<QByteArray> syncPacked;   // by profile, until it is complete
+    qint64 syncReceived = 0;
+    qint64 syncTotal = 0;
+    std::vector<QByteArray> syncDeferred; // command batches held back until the sync ends
 };
 
 #endif
@@ -1,11 +1,16 @@
 #include "networktransport.h"
+#include "core/Network/entitystate.h"
 
 NetworkTransport::NetworkTransport(){
     udpSocket = new QUdpSocket(this);
 }
 
 NetworkTransport::~NetworkTransport(){
-
+    if (m_ioThread) {
+        QMetaObject::invokeMethod(m_io, &ServerIo::stop, Qt::BlockingQueuedConnection);
+        m_ioThread->quit();
+        m_ioThread->wait();
+    }
 }
 
 void NetworkTransport::readyUDPRead()
@@ -20,57 +25,80 @@ void NetworkTransport::readyUDPRead()
         // Read the datagram and get the sender info
         udpSocket->readDatagram(datagram.data(), datagram.size(), &senderAddress, &senderPort);
 
+        // Entity state is binary and arrives every tick; no logging or text conversion
+        if (EntityStateView(datagram).isValid()) {
+            emit onStateDatagram(datagram);
+            continue;
+        }
+
         qDebug() << "Message from:" << senderAddress.toString() << ":" << senderPort;
         qDebug() << "Content:" << QString::fromUtf8(datagram);
         emit onReceivedMessage( QString::fromUtf8(datagram));
     }
 }
 
+// Legacy text datagram, to every client
 void NetworkTransport::sendUDPMessage(const QString &message)
 {
-    QByteArray datagram = message.toUtf8();
-
-    for (QWebSocket *client : m_clients)
-    {
-        // CRITICAL CHECK: Ensure the socket is connected before sending data
-        if (client && (client->state() == QAbstractSocket::ConnectedState))
-        {
-            qint64 bytesSent = udpSocket->writeDatagram(
-                datagram,
-                client->peerAddress(),
-                DESTINATION_PORT
-                );
-
-            if (bytesSent == -1) {
-                qDebug() << "Error sending datagram:" << udpSocket->errorString();
-            } else {
-                qDebug() << "Sent message (" << bytesSent << "bytes) to"
-                         << DESTINATION_ADDRESS.toString() << ":" << DESTINATION_PORT;
-            }
+    if (m_io) m_io->sendDatagram(0, message.toUtf8());
+}
 
-        }
-    }
+// Only the newest tick of entity state is worth sending, so state datagrams
+// are coalesced by their sequence number
+static quint32 coalesceKey(const QByteArray &datagram)
+{
+    EntityStateView view(datagram);
+    return view.isValid() ? view.sequence() : 0;
+}
+
+void NetworkTransport::sendUDPDatagram(const QByteArray &datagram)
+{
+    if (m_io) m_io->sendDatagram(0, datagram, coalesceKey(datagram));
+}
 
+void NetworkTransport::sendUDPDatagram(quint32 clientId, const QByteArray &datagram)
+{
+    if (m_io && clientId) m_io->sendDatagram(clientId, datagram, coalesceKey(datagram));
+}
+
+QVector<ClientMetrics> NetworkTransport::clientMetrics() const
+{
+    return m_io ? m_io->metrics() : QVector<ClientMetrics>();
 }
 
+qint64 NetworkTransport::queuedBytes(quint32 clientId) const
+{
+    return m_io ? m_io->queuedBytes(clientId) : 0;
+}
 
 bool NetworkTransport::isServer(){
     return Server;
 }
 
 void NetworkTransport::start(bool server){
-    if(m_server||m_webSocket)return;
+    if(m_io||m_webSocket)return;
     if(server){
-        m_server = new QWebSocketServer(QStringLiteral("My Server"), QWebSocketServer::NonSecureMode    );
-
-        if (m_server->listen(QHostAddress::Any, port)) {
-            qDebug() << "WebSocket server listening on port "<<port;
-            // Connect the server to a slot to handle new incoming connections
-            connect(m_server, &QWebSocketServer::newConnection, this, &NetworkTransport::NewConnection); // Assuming onNewConnection is added to mainwindow.h
-            Server = server;
-        } else {
-            qWarning() << "Could not start server.";
-        }
+        // Everything after this point happens on the I/O thread; results
+        // come back as queued signals
+        m_ioThread = new QThread(this);
+        m_ioThread->setObjectName("NetworkIO");
+        m_io = new ServerIo(port, DESTINATION_PORT);
+        m_io->moveToThread(m_ioThread);
+        connect(m_ioThread, &QThread::started, m_io, &ServerIo::start);
+        connect(m_ioThread, &QThread::finished, m_io, &QObject::deleteLater);
+        connect(m_io, &ServerIo::listening, this, [this](bool ok) { Server = ok; });
+        connect(m_io, &ServerIo::clientConnected, this, &NetworkTransport::ClientConnected);
+        connect(m_io, &ServerIo::clientDisconnected, this, &NetworkTransport::ClientDisconnected);
+        connect(m_io, &ServerIo::textReceived, this, [this](quint32 clientId, QString message) {
+            emit onClientMessage(clientId, message);
+            ReceivedMessage(message);
+        });
+        connect(m_io, &ServerIo::binaryReceived, this, [this](quint32 clientId, QByteArray byteMessage) {
+            emit onClientBinaryMessage(clientId, byteMessage);
+            emit onBinaryMessage(byteMessage);
+        });
+        connect(m_io, &ServerIo::metricsUpdated, this, &NetworkTransport::onClientMetrics);
+        m_ioThread->start();
     }else{
         m_webSocket = new QWebSocket();
 
@@ -81,17 +109,18 @@ void NetworkTransport::start(bool server){
         connect(m_webSocket, &QWebSocket::connected, this, &NetworkTransport::Connected);     // Assuming onConnected is added to mainwindow.h
         connect(m_webSocket, &QWebSocket::disconnected, this, &NetworkTransport::Disconnected); // Assuming onDisconnected is added to mainwindow.h
 
-        QString urlString = QString("ws://%1:%2").arg(address).arg(port);
-        m_webSocket->open(QUrl(urlString));
-
-        // Bind to the port
-        if (udpSocket->bind(QHostAddress::Any, DESTINATION_PORT,QUdpSocket::ShareAddress)) {
-            qDebug() << "UDP Receiver listening on port" << DESTINATION_PORT;
+        // Any free port, named in the handshake so the server sends this
+        // client's datagrams there and not to every client on the host
+        QUrl url(QString("ws://%1:%2").arg(address).arg(port));
+        if (udpSocket->bind(QHostAddress::Any, 0)) {
+            qDebug() << "UDP Receiver listening on port" << udpSocket->localPort();
             // Connect readyRead signal to a slot
             connect(udpSocket, &QUdpSocket::readyRead, this, &NetworkTransport::readyUDPRead);
+            url.setQuery(QString("udp=%1").arg(udpSocket->localPort()));
         } else {
             qDebug() << "Failed to bind socket:" << udpSocket->errorString();
         }
+        m_webSocket->open(url);
     }
 }
 
@@ -111,18 +140,19 @@ void NetworkTransport::sendMessage(QString message){
                        << m_webSocket->state() << ")";
         }
     }
-    if(m_server){
-        for (QWebSocket *client : m_clients)
-        {
-            // CRITICAL CHECK: Ensure the socket is connected before sending data
-            if (client && (client->state() == QAbstractSocket::ConnectedState))
-            {
-                client->sendTextMessage(message);
-            }
-        }
+    if(m_io){
+        m_io->sendText(0, message);
     }
 }
 
+void NetworkTransport::sendMessage(quint32 clientId, const QString &message){
+    if(m_io && clientId) m_io->sendText(clientId, message);
+}
+
+void NetworkTransport::sendBinaryMessage(quint32 clientId, const QByteArray &byteMessage){
+    if(m_io && clientId) m_io->sendBinary(clientId, byteMessage);
+}
+
 void NetworkTransport::sendBinaryMessage(QByteArray byteMessage){
     if(m_webSocket){
         // CRITICAL: Check if the socket is in the ConnectedState
@@ -134,36 +164,22 @@ void NetworkTransport::sendBinaryMessage(QByteArray byteMessage){
                        << m_webSocket->state() << ")";
         }
     }
-    if(m_server){
-        for (QWebSocket *client : m_clients)
-        {
-            // CRITICAL CHECK: Ensure the socket is connected before sending data
-            if (client && (client->state() == QAbstractSocket::ConnectedState))
-            {
-                client->sendBinaryMessage(byteMessage);
-            }
-        }
+    if(m_io){
+        m_io->sendBinary(0, byteMessage);
     }
 }
 
-void NetworkTransport::NewConnection(){
-    // The server has a new connection, accept it and get the client socket
-    QWebSocket *pSocket = m_server->nextPendingConnection();
-
-    qDebug() << "Client connected from:" << pSocket->peerAddress().toString();
-    // 1. Connect signal to handle incoming text messages from the client
-    // We connect to a generic slot like 'processTextMessage'
-    connect(pSocket, &QWebSocket::textMessageReceived, this, &NetworkTransport::ReceivedMessage);
-    connect(pSocket, &QWebSocket::binaryMessageReceived, this, &NetworkTransport::BinaryMessage);
-    // 2. Connect signal to know when the client disconnects
-    // We connect to a slot like 'socketDisconnected' which can clean up resources
-    connect(pSocket, &QWebSocket::disconnected, this, &NetworkTransport::Disconnected);
-
+void NetworkTransport::ClientConnected(quint32 clientId){
+    m_clientIds.insert(clientId);
     emit onNewConnection();
-    // If you were tracking multiple clients, you would add pSocket to a list here,
-    m_clients.append(pSocket);
+    emit onClientConnected(clientId);
 }
 
+void NetworkTransport::ClientDisconnected(quint32 clientId){
+    m_clientIds.remove(clientId);
+    emit onClientDisconnected(clientId);
+    emit onDisconnect();
+}
 
 void NetworkTransport::Connected(){
     emit onConnect();
@@ -188,6 +204,5 @@ void NetworkTransport::ReceivedMessage(QString message){
 }
 
 void NetworkTransport::BinaryMessage(QByteArray byteMessage){
-    qDebug()<<"Recive byte:" << byteMessage;
     emit onBinaryMessage(byteMessage);
 }
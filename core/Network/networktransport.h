@@ -2,10 +2,12 @@
 #define NETWORKTRANSPORT_H
 
 #include "qwebsocket.h"
-#include "qwebsocketserver.h"
+#include "core/Network/serverio.h"
 #include <QUdpSocket>
 #include <QHostAddress>
 #include <QObject>
+#include <QSet>
+#include <QThread>
 
 class NetworkTransport: public QObject
 {
@@ -18,12 +20,22 @@ public:
     void start(bool server = false);
     void sendMessage(QString message);
     void sendUDPMessage(const QString &message);
+    void sendUDPDatagram(const QByteArray &datagram);
+    void sendUDPDatagram(quint32 clientId, const QByteArray &datagram);
+    QList<quint32> clientIds() const { return m_clientIds.values(); }
     void sendBinaryMessage(QByteArray byteMessage);
     bool isServer();
+    // Server side, to one client
+    void sendMessage(quint32 clientId, const QString &message);
+    void sendBinaryMessage(quint32 clientId, const QByteArray &byteMessage);
+    // Server side, queue state of every client right now
+    QVector<ClientMetrics> clientMetrics() const;
+    qint64 queuedBytes(quint32 clientId) const;
 
 private slots:
     void readyUDPRead();
-    void NewConnection();
+    void ClientConnected(quint32 clientId);
+    void ClientDisconnected(quint32 clientId);
     void Connected();
     void Disconnected();
     void ErrorOccurred(const QList<QSslError> &errors);
@@ -37,10 +49,20 @@ signals:
     void onErrorOccurred(QString error);
     void onReceivedMessage(QString message);
     void onBinaryMessage(QByteArray byteMessage);
+    void onStateDatagram(QByteArray datagram);
+    // Server side, per connected client
+    void onClientConnected(quint32 clientId);
+    void onClientDisconnected(quint32 clientId);
+    void onClientMessage(quint32 clientId, QString message);
+    void onClientBinaryMessage(quint32 clientId, QByteArray byteMessage);
+    void onClientMetrics(QVector<ClientMetrics> metrics);
 private:
     QWebSocket *m_webSocket = nullptr;
-    QWebSocketServer *m_server = nullptr;
-    QList<QWebSocket *> m_clients;
+    // Server sockets live on their own thread so a slow client never
+    // blocks the simulation; see ServerIo
+    QThread *m_ioThread = nullptr;
+    ServerIo *m_io = nullptr;
+    QSet<quint32> m_clientIds;
     unsigned int port =3000;
     bool Server = false;
     QString address = "localhost";
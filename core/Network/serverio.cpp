@@ -0,0 +1,251 @@
+#include "serverio.h"
+#include <QDebug>
+#include <QUrlQuery>
+#include <algorithm>
+
+namespace {
+const int MetricsInterval = 1000; // ms
+const double DelaySmoothing = 0.05;
+}
+
+ServerIo::ServerIo(quint16 port, quint16 datagramPort) : m_port(port), m_datagramPort(datagramPort) {
+    qRegisterMetaType<QVector<ClientMetrics>>("QVector<ClientMetrics>");
+    m_clock.start();
+}
+
+ServerIo::~ServerIo() {
+    stop();
+}
+
+// Runs on the I/O thread, so every socket is created there
+void ServerIo::start() {
+    if (m_server) return;
+    m_server = new QWebSocketServer(QStringLiteral("My Server"), QWebSocketServer::NonSecureMode, this);
+    m_udp = new QUdpSocket(this);
+    const bool ok = m_server->listen(QHostAddress::Any, m_port);
+    if (ok) {
+        qDebug() << "WebSocket server listening on port " << m_port;
+        connect(m_server, &QWebSocketServer::newConnection, this, &ServerIo::acceptClient);
+    } else {
+        qWarning() << "Could not start server.";
+    }
+
+    m_metricsTimer = new QTimer(this);
+    connect(m_metricsTimer, &QTimer::timeout, this, [this]() { emit metricsUpdated(metrics()); });
+    m_metricsTimer->start(MetricsInterval);
+    emit listening(ok);
+}
+
+void ServerIo::stop() {
+    if (m_server) m_server->close();
+    std::vector<QWebSocket*> sockets;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& [id, client] : m_clients) sockets.push_back(client->socket);
+        m_clients.clear();
+    }
+    for (QWebSocket* socket : sockets) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+}
+
+void ServerIo::sendText(quint32 clientId, const QString& message) {
+    Outgoing outgoing;
+    outgoing.text = message;
+    outgoing.isText = true;
+    enqueue(clientId, outgoing);
+}
+
+void ServerIo::sendBinary(quint32 clientId, const QByteArray& message) {
+    Outgoing outgoing;
+    outgoing.binary = message;
+    enqueue(clientId, outgoing);
+}
+
+void ServerIo::enqueue(quint32 clientId, const Outgoing& message) {
+    Outgoing queued = message;
+    queued.queuedAt = m_clock.nsecsElapsed();
+    const qint64 size = queued.size();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto push = [&](Client& client) {
+            if (client.overflowed) return;
+            if (!client.messages.empty() && client.messageBytes + size > MaxQueuedBytes) {
+                client.overflowed = true;
+                return;
+            }
+            client.messageBytes += size;
+            client.messages.push_back(queued); // payloads are shared, not copied
+        };
+        if (clientId) {
+            auto it = m_clients.find(clientId);
+            if (it == m_clients.end()) return;
+            push(*it->second);
+        } else {
+            for (auto& [id, client] : m_clients) push(*client);
+        }
+    }
+    wake();
+}
+
+void ServerIo::sendDatagram(quint32 clientId, const QByteArray& datagram, quint32 coalesceKey) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto push = [&](Client& client) {
+            std::vector<Datagram>& queue = client.datagrams;
+            if (coalesceKey) {
+                const auto stale = std::remove_if(queue.begin(), queue.end(), [&](const Datagram& queued) {
+                    return queued.key && queued.key != coalesceKey;
+                });
+                client.staleDatagrams += queue.end() - stale;
+                queue.erase(stale, queue.end());
+            }
+            if (queue.size() >= static_cast<size_t>(MaxQueuedDatagrams)) {
+                queue.erase(queue.begin());
+                client.staleDatagrams++;
+            }
+            queue.push_back({datagram, coalesceKey});
+        };
+        if (clientId) {
+            auto it = m_clients.find(clientId);
+            if (it == m_clients.end()) return;
+            push(*it->second);
+        } else {
+            for (auto& [id, client] : m_clients) push(*client);
+        }
+    }
+    wake();
+}
+
+// One queued flush however many messages arrive before the I/O thread runs
+void ServerIo::wake() {
+    if (m_wakePending.exchange(true)) return;
+    QMetaObject::invokeMethod(this, [this]() { flush(); }, Qt::QueuedConnection);
+}
+
+void ServerIo::flush() {
+    m_wakePending = false;
+    std::vector<quint32> overflowed;
+    for (auto& [id, client] : m_clients) {
+        if (client->overflowed) {
+            overflowed.push_back(id);
+            continue;
+        }
+        flushClient(*client);
+    }
+    for (quint32 id : overflowed) {
+        qWarning() << "[ServerIo] Client" << id << "fell more than" << MaxQueuedBytes << "bytes behind, disconnecting";
+        auto it = m_clients.find(id);
+        if (it != m_clients.end()) it->second->socket->abort();
+    }
+}
+
+// Datagrams all go out, messages only while the socket buffer is below
+// SocketHighWater; the rest wait for bytesWritten
+void ServerIo::flushClient(Client& client) {
+    std::vector<Datagram> datagrams;
+    std::vector<Outgoing> messages;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        datagrams.swap(client.datagrams);
+        qint64 room = SocketHighWater - client.socket->bytesToWrite();
+        while (!client.messages.empty() && room > 0) {
+            const qint64 size = client.messages.front().size();
+            room -= size;
+            client.messageBytes -= size;
+            messages.push_back(std::move(client.messages.front()));
+            client.messages.pop_front();
+        }
+    }
+
+    quint64 sent = 0;
+    for (const Datagram& datagram : datagrams) {
+        if (m_udp->writeDatagram(datagram.data, client.address, client.datagramPort) == -1) {
+            qDebug() << "Error sending datagram:" << m_udp->errorString();
+            continue;
+        }
+        sent += datagram.data.size();
+    }
+    const qint64 now = m_clock.nsecsElapsed();
+    double delay = client.meanDelay;
+    for (const Outgoing& message : messages) {
+        sent += message.isText ? client.socket->sendTextMessage(message.text) : client.socket->sendBinaryMessage(message.binary);
+        delay += ((now - message.queuedAt) / 1e9 - delay) * DelaySmoothing;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    client.bytesSent += sent;
+    client.meanDelay = delay;
+    client.socketBytes = client.socket->bytesToWrite();
+}
+
+void ServerIo::acceptClient() {
+    while (m_server->hasPendingConnections()) {
+        QWebSocket* socket = m_server->nextPendingConnection();
+        const quint32 id = m_nextClientId++;
+        qDebug() << "Client connected from:" << socket->peerAddress().toString();
+
+        std::unique_ptr<Client> client(new Client());
+        client->id = id;
+        client->socket = socket;
+        client->address = socket->peerAddress();
+        // Clients bind a UDP port of their own and name it as ?udp= in the
+        // handshake, so several on one host each get only their own datagrams
+        const quint16 reportedPort = QUrlQuery(socket->requestUrl()).queryItemValue("udp").toUShort();
+        client->datagramPort = reportedPort ? reportedPort : m_datagramPort;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_clients[id] = std::move(client);
+        }
+        connect(socket, &QWebSocket::textMessageReceived, this, [this, id](const QString& message) { emit textReceived(id, message); });
+        connect(socket, &QWebSocket::binaryMessageReceived, this, [this, id](const QByteArray& message) { emit binaryReceived(id, message); });
+        connect(socket, &QWebSocket::bytesWritten, this, [this, id]() {
+            auto it = m_clients.find(id);
+            if (it != m_clients.end() && !it->second->overflowed) flushClient(*it->second);
+        });
+        connect(socket, &QWebSocket::disconnected, this, [this, id]() { removeClient(id); });
+        emit clientConnected(id);
+    }
+}
+
+void ServerIo::removeClient(quint32 clientId) {
+    QWebSocket* socket = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_clients.find(clientId);
+        if (it == m_clients.end()) return;
+        socket = it->second->socket;
+        m_clients.erase(it);
+    }
+    socket->deleteLater();
+    emit clientDisconnected(clientId);
+}
+
+qint64 ServerIo::queuedBytes(quint32 clientId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_clients.find(clientId);
+    return it == m_clients.end() ? 0 : it->second->messageBytes + it->second->socketBytes;
+}
+
+QVector<ClientMetrics> ServerIo::metrics() const {
+    const qint64 now = m_clock.nsecsElapsed();
+    QVector<ClientMetrics> out;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out.reserve(static_cast<int>(m_clients.size()));
+    for (const auto& [id, client] : m_clients) {
+        ClientMetrics metrics;
+        metrics.clientId = id;
+        metrics.address = client->address.toString() + ':' + QString::number(client->datagramPort);
+        metrics.queuedMessages = static_cast<int>(client->messages.size());
+        metrics.queuedBytes = client->messageBytes + client->socketBytes;
+        metrics.queuedDatagrams = static_cast<int>(client->datagrams.size());
+        metrics.oldestMessageAge = client->messages.empty() ? 0.0 : (now - client->messages.front().queuedAt) / 1e9;
+        metrics.meanQueueDelay = client->meanDelay;
+        metrics.bytesSent = client->bytesSent;
+        metrics.staleDatagrams = client->staleDatagrams;
+        out.push_back(metrics);
+    }
+    return out;
+}
@@ -0,0 +1,122 @@
+#ifndef SERVERIO_H
+#define SERVERIO_H
+
+#include "qwebsocket.h"
+#include "qwebsocketserver.h"
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QMetaType>
+#include <QObject>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QVector>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// One client's send queue, published about once a second
+struct ClientMetrics {
+    quint32 clientId = 0;
+    QString address;
+    int queuedMessages = 0;        // reliable messages not yet handed to the socket
+    qint64 queuedBytes = 0;        // those plus what the socket still buffers
+    int queuedDatagrams = 0;
+    double oldestMessageAge = 0.0; // seconds the head of the queue has waited
+    double meanQueueDelay = 0.0;   // seconds from enqueue to socket
+    double roundTrip = -1.0;       // state tick to its ack, filled in by NetworkManager
+    quint64 bytesSent = 0;
+    quint64 staleDatagrams = 0;    // state replaced by a newer tick before it went out
+};
+Q_DECLARE_METATYPE(QVector<ClientMetrics>)
+
+// Server side of the transport, living on its own I/O thread. Other threads
+// only append to per-client queues, which never waits on a socket; the I/O
+// thread hands each client its messages as fast as that client takes them,
+// so a slow client only fills its own queue. Reliable messages cannot be
+// dropped: a client whose queue outgrows MaxQueuedBytes is disconnected and
+// resyncs when it reconnects. A state tick still queued when the next one
+// arrives is dropped, the client would ignore it anyway.
+class ServerIo : public QObject
+{
+    Q_OBJECT
+public:
+    static const qint64 MaxQueuedBytes = 32 * 1024 * 1024;
+    static const qint64 SocketHighWater = 256 * 1024; // left with the socket before holding back
+    static const int MaxQueuedDatagrams = 256;
+
+    ServerIo(quint16 port, quint16 datagramPort);
+    ~ServerIo();
+
+    // Thread-safe; clientId 0 sends to every client. A datagram with a
+    // coalesce key replaces queued ones that have a different key.
+    void sendText(quint32 clientId, const QString& message);
+    void sendBinary(quint32 clientId, const QByteArray& message);
+    void sendDatagram(quint32 clientId, const QByteArray& datagram, quint32 coalesceKey = 0);
+    QVector<ClientMetrics> metrics() const;
+    // Reliable bytes waiting for clientId, queue and socket buffer
+    qint64 queuedBytes(quint32 clientId) const;
+
+public slots:
+    void start();
+    void stop();
+
+signals:
+    void listening(bool ok);
+    void clientConnected(quint32 clientId);
+    void clientDisconnected(quint32 clientId);
+    void textReceived(quint32 clientId, QString message);
+    void binaryReceived(quint32 clientId, QByteArray message);
+    void metricsUpdated(QVector<ClientMetrics> metrics);
+
+private:
+    struct Outgoing {
+        QString text;
+        QByteArray binary;
+        bool isText = false;
+        qint64 queuedAt = 0;
+        qint64 size() const { return isText ? text.size() * 2 : binary.size(); }
+    };
+    struct Datagram {
+        QByteArray data;
+        quint32 key = 0;
+    };
+    struct Client {
+        quint32 id = 0;
+        QWebSocket* socket = nullptr; // I/O thread only
+        QHostAddress address;
+        quint16 datagramPort = 0;     // from the handshake URL, else the default port
+        std::deque<Outgoing> messages;
+        std::vector<Datagram> datagrams;
+        qint64 messageBytes = 0;
+        qint64 socketBytes = 0;       // socket buffer after the last flush
+        double meanDelay = 0.0;
+        quint64 bytesSent = 0;
+        quint64 staleDatagrams = 0;
+        std::atomic<bool> overflowed{false}; // set under the lock, read by the I/O thread without it
+    };
+
+    void enqueue(quint32 clientId, const Outgoing& message);
+    void wake();
+    void flush();
+    void flushClient(Client& client);
+    void acceptClient();
+    void removeClient(quint32 clientId);
+
+    const quint16 m_port;
+    const quint16 m_datagramPort; // for clients that do not name their own
+    QWebSocketServer* m_server = nullptr;
+    QUdpSocket* m_udp = nullptr;
+    QTimer* m_metricsTimer = nullptr;
+    QElapsedTimer m_clock;
+    // The map only changes on the I/O thread, under the lock; queues change
+    // on any thread, under the lock
+    mutable std::mutex m_mutex;
+    std::unordered_map<quint32, std::unique_ptr<Client>> m_clients;
+    std::atomic<bool> m_wakePending{false};
+    quint32 m_nextClientId = 1;
+};
+
+#endif // SERVERIO_H
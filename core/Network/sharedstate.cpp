@@ -0,0 +1,153 @@
+#include "sharedstate.h"
+#include <QDebug>
+#include <cstring>
+#include <new>
+
+using namespace SharedStateFormat;
+
+namespace {
+const int ReadAttempts = 4; // a reader overtaken this often by a 20 Hz writer is stalled anyway
+}
+
+bool SharedStateWriter::open(const QString& key, int frameCapacity) {
+    close();
+    m_memory.setKey(key);
+    const int size = segmentSize(frameCapacity);
+    if (!m_memory.create(size)) {
+        // Left behind by a server that did not shut down cleanly
+        if (m_memory.error() != QSharedMemory::AlreadyExists || !m_memory.attach() || m_memory.size() < size) {
+            qWarning() << "[SharedState] Could not create" << key << ":" << m_memory.errorString();
+            m_memory.detach();
+            return false;
+        }
+    }
+    char* data = static_cast<char*>(m_memory.data());
+    m_header = new (data) SharedHeader;
+    std::memcpy(m_header->magic, SegmentMagic, sizeof(SegmentMagic));
+    m_header->version = Version;
+    m_header->capacity = static_cast<quint32>(frameCapacity);
+    m_header->latest.store(0, std::memory_order_relaxed);
+    m_header->sequence[0].store(0, std::memory_order_relaxed);
+    m_header->sequence[1].store(0, std::memory_order_release);
+    m_buffers = data + bufferOffset();
+    m_capacity = frameCapacity;
+    m_bufferIndex[0] = m_bufferIndex[1] = 0;
+    qDebug() << "[SharedState] Publishing entity state as" << key;
+    return true;
+}
+
+void SharedStateWriter::close() {
+    if (m_memory.isAttached()) m_memory.detach();
+    m_header = nullptr;
+    m_buffers = nullptr;
+}
+
+void SharedStateWriter::publish(const EntitySnapshot& snapshot, double serverTime, const QByteArray& index, quint32 indexVersion) {
+    if (!m_header) return;
+    m_rows.clear();
+    for (const EntityStateFormat::EntityState& row : snapshot.rows) {
+        if (row.index != EntityStateFormat::NoEntity) m_rows.push_back(row);
+    }
+    const size_t rowBytes = m_rows.size() * sizeof(EntityStateFormat::EntityState);
+    if (sizeof(FrameHeader) + index.size() + rowBytes > static_cast<size_t>(m_capacity)) {
+        if (m_oversized++ == 0) qWarning() << "[SharedState] Tick" << snapshot.sequence << "does not fit in" << m_capacity << "bytes, not published";
+        return;
+    }
+
+    // Readers are pointed at latest, so the other buffer is free to fill
+    const quint32 buffer = 1 - m_header->latest.load(std::memory_order_relaxed);
+    char* frame = m_buffers + buffer * m_capacity;
+    std::atomic<quint32>& sequence = m_header->sequence[buffer];
+    const quint32 writing = sequence.load(std::memory_order_relaxed) + 1;
+    sequence.store(writing, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    FrameHeader header = {};
+    std::memcpy(header.magic, FrameMagic, sizeof(FrameMagic));
+    header.version = EntityStateFormat::Version;
+    header.sequence = snapshot.sequence;
+    header.serverTime = serverTime;
+    header.count = static_cast<quint32>(m_rows.size());
+    header.indexVersion = indexVersion;
+    header.indexBytes = static_cast<quint32>(index.size());
+    std::memcpy(frame, &header, sizeof(header));
+    if (indexVersion == 0 || m_bufferIndex[buffer] != indexVersion) {
+        std::memcpy(frame + sizeof(header), index.constData(), index.size());
+        m_bufferIndex[buffer] = indexVersion;
+    }
+    std::memcpy(frame + sizeof(header) + index.size(), m_rows.data(), rowBytes);
+
+    sequence.store(writing + 1, std::memory_order_release);
+    m_header->latest.store(buffer, std::memory_order_release);
+}
+
+bool SharedStateReader::attach(const QString& key) {
+    detach();
+    m_memory.setKey(key);
+    if (!m_memory.attach(QSharedMemory::ReadOnly)) return false;
+    const auto* header = static_cast<const SharedHeader*>(m_memory.constData());
+    if (m_memory.size() < static_cast<int>(sizeof(SharedHeader)) || std::memcmp(header->magic, SegmentMagic, sizeof(SegmentMagic)) != 0 ||
+        header->version != Version || m_memory.size() < segmentSize(static_cast<int>(header->capacity))) {
+        qWarning() << "[SharedState]" << key << "is not an entity state segment of version" << Version;
+        m_memory.detach();
+        return false;
+    }
+    m_header = header;
+    m_buffers = static_cast<const char*>(m_memory.constData()) + bufferOffset();
+    m_capacity = static_cast<int>(header->capacity);
+    m_sequence = 0;
+    m_indexVersion = 0;
+    return true;
+}
+
+void SharedStateReader::detach() {
+    if (m_memory.isAttached()) m_memory.detach();
+    m_header = nullptr;
+    m_buffers = nullptr;
+}
+
+// Copies first and checks afterwards; a copy the writer touched meanwhile
+// shows as a changed sequence and is thrown away
+bool SharedStateReader::read() {
+    if (!m_header) return false;
+    for (int attempt = 0; attempt < ReadAttempts; ++attempt) {
+        const quint32 buffer = m_header->latest.load(std::memory_order_acquire) & 1;
+        const quint32 begin = m_header->sequence[buffer].load(std::memory_order_acquire);
+        if (begin == 0) return false; // nothing published yet
+        if (begin & 1) continue;
+
+        const char* frame = m_buffers + buffer * m_capacity;
+        FrameHeader header;
+        std::memcpy(&header, frame, sizeof(header));
+        const size_t rowBytes = static_cast<size_t>(header.count) * sizeof(EntityStateFormat::EntityState);
+        const bool valid = std::memcmp(header.magic, FrameMagic, sizeof(FrameMagic)) == 0 && header.version == EntityStateFormat::Version &&
+                           sizeof(header) + header.indexBytes + rowBytes <= static_cast<size_t>(m_capacity);
+        const bool fresh = valid && header.sequence != m_sequence;
+        const bool newIndex = fresh && header.indexVersion != m_indexVersion;
+        if (fresh) {
+            m_scratch.resize(header.count);
+            std::memcpy(m_scratch.data(), frame + sizeof(header) + header.indexBytes, rowBytes);
+            if (newIndex) m_index = QByteArray(frame + sizeof(header), static_cast<int>(header.indexBytes));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_header->sequence[buffer].load(std::memory_order_relaxed) != begin) continue;
+        if (!fresh) return false;
+
+        m_states.swap(m_scratch);
+        m_sequence = header.sequence;
+        m_serverTime = header.serverTime;
+        if (newIndex) {
+            std::vector<std::pair<quint16, std::string>> entries;
+            if (EntityStateFormat::decodeIndex(m_index, entries)) {
+                m_ids.clear();
+                for (const auto& [index, id] : entries) {
+                    if (index >= m_ids.size()) m_ids.resize(index + 1);
+                    m_ids[index] = id;
+                }
+                m_indexVersion = header.indexVersion;
+            }
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,117 @@
+#ifndef SHAREDSTATE_H
+#define SHAREDSTATE_H
+
+#include "core/Network/entitystate.h"
+#include <QByteArray>
+#include <QSharedMemory>
+#include <QString>
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Entity state for viewers and tools on the same machine, without sockets.
+// The server writes every tick into a shared memory segment holding two
+// frame buffers; it always fills the one readers are not pointed at, then
+// flips. Each buffer is guarded by a seqlock, so the writer never waits for
+// a reader and a reader that was overtaken just copies again.
+//
+//   segment   SharedHeader, padding to BufferAlign, two buffers of capacity
+//   frame     FrameHeader, index message (see entitystate.h), EntityState[count]
+//
+// The index message maps every wire index to its entity ID and changes
+// only when entities are added, so readers decode it once per indexVersion.
+namespace SharedStateFormat {
+
+const char SegmentMagic[4] = {'T', 'D', 'F', 'S'};
+const char FrameMagic[2] = {'E', 'M'};
+const quint32 Version = 1;
+const int DefaultFrameCapacity = 4 * 1024 * 1024; // every possible wire index with long IDs
+const int BufferAlign = 64;
+
+static_assert(std::atomic<quint32>::is_always_lock_free, "seqlock counters are shared between processes");
+
+struct SharedHeader {
+    char magic[4];
+    quint32 version;
+    quint32 capacity;                 // bytes per frame buffer
+    std::atomic<quint32> latest;      // buffer holding the newest complete frame
+    std::atomic<quint32> sequence[2]; // per buffer, odd while it is written
+};
+
+#pragma pack(push, 1)
+struct FrameHeader {
+    char magic[2];
+    quint8 version;   // EntityStateFormat::Version of the rows
+    quint8 reserved;
+    quint32 sequence; // server tick
+    double serverTime;
+    quint32 count;
+    quint32 indexVersion;
+    quint32 indexBytes;
+};
+#pragma pack(pop)
+
+inline int bufferOffset() { return (static_cast<int>(sizeof(SharedHeader)) + BufferAlign - 1) / BufferAlign * BufferAlign; }
+inline int segmentSize(int capacity) { return bufferOffset() + 2 * capacity; }
+// Segment of the server listening on port
+inline QString keyForPort(int port) { return QStringLiteral("TDF.EntityState.%1").arg(port); }
+
+}
+
+// Server side; publish() is meant to be called once per network tick
+class SharedStateWriter
+{
+public:
+    bool open(const QString& key, int frameCapacity = SharedStateFormat::DefaultFrameCapacity);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+
+    // Rows of absent entities are left out. index is an encodeIndex message
+    // of every entry, copied only into buffers holding an older indexVersion.
+    void publish(const EntitySnapshot& snapshot, double serverTime, const QByteArray& index, quint32 indexVersion);
+
+    quint64 oversizedFrames() const { return m_oversized; }
+
+private:
+    QSharedMemory m_memory;
+    SharedStateFormat::SharedHeader* m_header = nullptr;
+    char* m_buffers = nullptr;
+    int m_capacity = 0;
+    quint32 m_bufferIndex[2] = {0, 0}; // indexVersion each buffer holds
+    std::vector<EntityStateFormat::EntityState> m_rows;
+    quint64 m_oversized = 0;
+};
+
+// Viewer side
+class SharedStateReader
+{
+public:
+    bool attach(const QString& key);
+    void detach();
+    bool isAttached() const { return m_header != nullptr; }
+
+    // Copies the newest frame; false when there is none, it is the one
+    // already read, or the writer kept overtaking the copy
+    bool read();
+
+    quint32 sequence() const { return m_sequence; }
+    double serverTime() const { return m_serverTime; }
+    const std::vector<EntityStateFormat::EntityState>& states() const { return m_states; }
+    // Entity ID by wire index, empty where unknown
+    const std::vector<std::string>& ids() const { return m_ids; }
+
+private:
+    QSharedMemory m_memory;
+    const SharedStateFormat::SharedHeader* m_header = nullptr;
+    const char* m_buffers = nullptr;
+    int m_capacity = 0;
+    quint32 m_sequence = 0;
+    double m_serverTime = 0.0;
+    quint32 m_indexVersion = 0;
+    std::vector<EntityStateFormat::EntityState> m_states, m_scratch;
+    std::vector<std::string> m_ids;
+    QByteArray m_index;
+};
+
+#endif // SHAREDSTATE_H
@@ -0,0 +1,144 @@
+#include "stateinterpolator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const double Smoothing = 0.1;          // weight of a new tick in the running means
+const double OffsetDrift = 0.01;       // seconds per second the clock offset may fall back
+const double ResyncThreshold = 1.0;    // server clock going back this far is a new server
+const double InterpolationTicks = 2.0; // survives one lost tick without extrapolating
+const double DefaultDelay = 0.1;
+const double MaxDelay = 1.0;
+const double MaxSlew = 0.1;            // render clock runs at most 10% fast or slow to catch up
+const double SnapThreshold = 0.5;      // further off than this it jumps
+}
+
+void StateInterpolator::reset() {
+    m_tracks.clear();
+    m_synced = false;
+    m_offset = m_jitter = m_interval = 0.0;
+    m_lastServerTime = m_lastLocalTime = 0.0;
+    m_rendering = false;
+}
+
+void StateInterpolator::addTick(double serverTime, double localTime) {
+    if (m_synced && serverTime + ResyncThreshold < m_lastServerTime) reset();
+    const double offset = serverTime - localTime;
+    if (!m_synced) {
+        m_synced = true;
+        m_offset = offset;
+        m_rendering = false;
+    } else {
+        // Delays only ever make a tick look late, so the offset follows the
+        // least delayed one, slowly giving way when the route gets longer
+        m_offset = std::max(offset, m_offset - OffsetDrift * (localTime - m_lastLocalTime));
+        m_jitter += (m_offset - offset - m_jitter) * Smoothing;
+        const double interval = serverTime - m_lastServerTime;
+        if (interval > 0.0) m_interval = m_interval > 0.0 ? m_interval + (interval - m_interval) * Smoothing : interval;
+    }
+    m_lastServerTime = std::max(m_lastServerTime, serverTime);
+    m_lastLocalTime = localTime;
+}
+
+void StateInterpolator::addSample(quint16 index, double serverTime, const EntityStateFormat::EntityState& state) {
+    if (index >= m_tracks.size()) m_tracks.resize(index + 1);
+    Track& track = m_tracks[index];
+    if (track.count > 0 && serverTime < track.sample(0).time) return;
+    if (track.count == 0 || serverTime > track.sample(0).time) {
+        track.newest = (track.newest + 1) % SampleCapacity;
+        track.count = std::min(track.count + 1, SampleCapacity);
+    }
+    Sample& sample = track.samples[track.newest];
+    sample.time = serverTime;
+    sample.state = state;
+    sample.position = EntityStateFormat::statePosition(state);
+    sample.orientation = EntityStateFormat::unpackOrientation(state.orientation);
+}
+
+void StateInterpolator::holdSample(quint16 index, double serverTime, const EntityStateFormat::EntityState& state) {
+    if (index >= m_tracks.size() || m_tracks[index].count == 0) return;
+    const Sample& newest = m_tracks[index].sample(0);
+    if (newest.time < serverTime && EntityStateFormat::sameState(newest.state, state)) addSample(index, serverTime, state);
+}
+
+double StateInterpolator::interpolationDelay() const {
+    if (m_fixedDelay > 0.0) return m_fixedDelay;
+    if (m_interval <= 0.0) return DefaultDelay;
+    return std::min(MaxDelay, InterpolationTicks * m_interval + 2.0 * m_jitter);
+}
+
+// The render clock follows local time and only slews towards the target,
+// so a better clock estimate or a new delay never shows as a jump
+double StateInterpolator::renderTime(double localTime) {
+    const double target = localTime + m_offset - interpolationDelay();
+    double time = target;
+    if (m_rendering) {
+        const double elapsed = std::max(0.0, localTime - m_lastRenderLocal);
+        time = m_lastRenderTime + elapsed;
+        const double behind = target - time;
+        if (std::abs(behind) > SnapThreshold) {
+            time = target;
+        } else {
+            time += std::max(-MaxSlew * elapsed, std::min(MaxSlew * elapsed, behind));
+        }
+        time = std::max(time, m_lastRenderTime);
+    }
+    m_rendering = true;
+    m_lastRenderTime = time;
+    m_lastRenderLocal = localTime;
+    return time;
+}
+
+bool StateInterpolator::evaluate(quint16 index, double time, QVector3D& position, QQuaternion& orientation) {
+    if (index >= m_tracks.size() || m_tracks[index].count == 0) return false;
+    Track& track = m_tracks[index];
+    const Sample& newest = track.sample(0);
+
+    bool extrapolating = false;
+    if (time >= newest.time) {
+        // Dead reckoning from the last two samples; a long gap means the
+        // entity was out of view and its old velocity says nothing
+        QVector3D velocity;
+        if (track.count > 1) {
+            const Sample& previous = track.sample(1);
+            const double gap = newest.time - previous.time;
+            if (gap > 0.0 && gap <= MaxExtrapolation) velocity = (newest.position - previous.position) * float(1.0 / gap);
+        }
+        const double ahead = std::min(time - newest.time, MaxExtrapolation);
+        position = newest.position + velocity * float(ahead);
+        orientation = newest.orientation;
+        extrapolating = ahead > 0.0;
+    } else {
+        int age = 1;
+        while (age < track.count && track.sample(age).time > time) ++age;
+        if (age == track.count) {
+            position = track.sample(age - 1).position; // older than anything kept
+            orientation = track.sample(age - 1).orientation;
+        } else {
+            const Sample& from = track.sample(age);
+            const Sample& to = track.sample(age - 1);
+            const float t = float((time - from.time) / (to.time - from.time));
+            position = from.position + (to.position - from.position) * t;
+            orientation = QQuaternion::slerp(from.orientation, to.orientation, t);
+        }
+    }
+
+    // A fresh sample replaced an extrapolated guess: start from what was on
+    // screen and let the difference decay instead of jumping
+    if (track.shown) {
+        if (track.extrapolating && newest.time != track.shownBase) {
+            track.error = track.shownPosition - position;
+            if (track.error.lengthSquared() > SnapDistance * SnapDistance) track.error = QVector3D();
+        }
+        track.error *= float(std::exp(-std::max(0.0, time - track.shownTime) / CorrectionTime));
+    }
+    position += track.error;
+    if (extrapolating) m_extrapolated++;
+
+    track.shown = true;
+    track.extrapolating = extrapolating;
+    track.shownTime = time;
+    track.shownBase = newest.time;
+    track.shownPosition = position;
+    return true;
+}
@@ -0,0 +1,81 @@
+#ifndef STATEINTERPOLATOR_H
+#define STATEINTERPOLATOR_H
+
+#include "core/Network/entitystate.h"
+#include <QQuaternion>
+#include <QVector3D>
+#include <QtGlobal>
+#include <vector>
+
+// Client side: turns the irregular stream of entity states into smooth
+// motion. Entities are shown an interpolation delay behind the estimated
+// server clock, so there are normally two samples around the shown time
+// even at a 5-10 Hz send rate. When samples are late the last velocity is
+// extrapolated for a while instead, and the jump back onto the real track
+// is blended out over a few frames.
+class StateInterpolator
+{
+public:
+    static const int SampleCapacity = 16;           // per entity
+    static constexpr double MaxExtrapolation = 1.0; // seconds past the newest sample
+    static constexpr double CorrectionTime = 0.1;   // decay of the blended-out error
+    static constexpr float SnapDistance = 100.0f;   // corrections larger than this teleport
+
+    void reset();
+
+    // Once per received tick, localTime in seconds on any steady clock
+    void addTick(double serverTime, double localTime);
+    // Samples older than the newest one of the entity are ignored
+    void addSample(quint16 index, double serverTime, const EntityStateFormat::EntityState& state);
+    // Marks an entity a snapshot left unchanged as still there at serverTime;
+    // ignored when state is not what its newest sample shows
+    void holdSample(quint16 index, double serverTime, const EntityStateFormat::EntityState& state);
+
+    // Server time to show at localTime; never moves backwards
+    double renderTime(double localTime);
+    // False while nothing was received for index
+    bool evaluate(quint16 index, double time, QVector3D& position, QQuaternion& orientation);
+
+    // 0 follows the measured send interval and jitter
+    void setInterpolationDelay(double seconds) { m_fixedDelay = seconds; }
+    double interpolationDelay() const;
+
+    quint64 extrapolatedFrames() const { return m_extrapolated; }
+
+private:
+    struct Sample {
+        double time = 0.0;
+        EntityStateFormat::EntityState state;
+        QVector3D position;
+        QQuaternion orientation;
+    };
+    struct Track {
+        Sample samples[SampleCapacity];
+        int count = 0;
+        int newest = -1;
+        // What the last frame showed, to blend out corrections
+        bool shown = false;
+        bool extrapolating = false;
+        double shownTime = 0.0;
+        double shownBase = 0.0; // newest sample time it was computed from
+        QVector3D shownPosition;
+        QVector3D error;
+
+        const Sample& sample(int age) const { return samples[(newest - age + SampleCapacity) % SampleCapacity]; }
+    };
+
+    std::vector<Track> m_tracks; // by wire index
+    bool m_synced = false;
+    double m_offset = 0.0;       // server time - local time of the least delayed tick
+    double m_jitter = 0.0;       // mean extra delay of a tick
+    double m_interval = 0.0;     // mean time between ticks
+    double m_lastServerTime = 0.0;
+    double m_lastLocalTime = 0.0;
+    bool m_rendering = false;
+    double m_lastRenderTime = 0.0;
+    double m_lastRenderLocal = 0.0;
+    double m_fixedDelay = 0.0;
+    quint64 m_extrapolated = 0;
+};
+
+#endif // STATEINTERPOLATOR_H
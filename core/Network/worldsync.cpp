@@ -0,0 +1,120 @@
+#include "worldsync.h"
+#include <QJsonDocument>
+#include <algorithm>
+#include <cstring>
+
+using namespace WorldSyncFormat;
+
+namespace {
+template <typename T>
+void appendRaw(QByteArray& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename Header>
+bool readHeader(const QByteArray& message, const char (&magic)[2], Header& header) {
+    if (message.size() < static_cast<int>(sizeof(Header))) return false;
+    std::memcpy(&header, message.constData(), sizeof(header));
+    return std::memcmp(header.magic, magic, sizeof(magic)) == 0 && header.version == Version;
+}
+}
+
+QByteArray WorldSyncFormat::packProfile(const QJsonObject& profile) {
+    return qCompress(QJsonDocument(profile).toJson(QJsonDocument::Compact));
+}
+
+bool WorldSyncFormat::unpackProfile(const QByteArray& packed, QJsonObject& out) {
+    const QByteArray json = qUncompress(packed);
+    if (json.isEmpty()) return false;
+    const QJsonDocument doc = QJsonDocument::fromJson(json);
+    if (!doc.isObject()) return false;
+    out = doc.object();
+    return true;
+}
+
+QByteArray WorldSyncFormat::encodeBegin(quint32 syncId, const std::vector<ProfileEntry>& profiles) {
+    BeginHeader header;
+    std::memcpy(header.magic, BeginMagic, sizeof(header.magic));
+    header.version = Version;
+    header.reserved = 0;
+    header.syncId = syncId;
+    header.profileCount = static_cast<quint32>(profiles.size());
+    header.totalBytes = 0;
+    for (const ProfileEntry& profile : profiles) header.totalBytes += profile.packedSize;
+
+    QByteArray message;
+    appendRaw(message, header);
+    for (const ProfileEntry& profile : profiles) {
+        const quint16 length = static_cast<quint16>(std::min<size_t>(profile.id.size(), 0xFFFF));
+        appendRaw(message, profile.packedSize);
+        appendRaw(message, length);
+        message.append(profile.id.data(), length);
+    }
+    return message;
+}
+
+bool WorldSyncFormat::decodeBegin(const QByteArray& message, quint32& syncId, std::vector<ProfileEntry>& out) {
+    out.clear();
+    BeginHeader header;
+    if (!readHeader(message, BeginMagic, header)) return false;
+
+    const char* data = message.constData();
+    size_t offset = sizeof(header);
+    const size_t size = static_cast<size_t>(message.size());
+    for (quint32 i = 0; i < header.profileCount; ++i) {
+        ProfileEntry entry;
+        quint16 length = 0;
+        if (size - offset < sizeof(entry.packedSize) + sizeof(length)) return false;
+        std::memcpy(&entry.packedSize, data + offset, sizeof(entry.packedSize));
+        std::memcpy(&length, data + offset + sizeof(entry.packedSize), sizeof(length));
+        offset += sizeof(entry.packedSize) + sizeof(length);
+        if (size - offset < length) return false;
+        entry.id.assign(data + offset, length);
+        offset += length;
+        out.push_back(std::move(entry));
+    }
+    syncId = header.syncId;
+    return true;
+}
+
+QByteArray WorldSyncFormat::encodeChunk(quint32 syncId, quint32 profile, quint32 offset, const char* data, int length) {
+    ChunkHeader header;
+    std::memcpy(header.magic, ChunkMagic, sizeof(header.magic));
+    header.version = Version;
+    header.reserved = 0;
+    header.syncId = syncId;
+    header.profile = profile;
+    header.offset = offset;
+
+    QByteArray message;
+    message.reserve(static_cast<int>(sizeof(header)) + length);
+    appendRaw(message, header);
+    message.append(data, length);
+    return message;
+}
+
+bool WorldSyncFormat::decodeChunk(const QByteArray& message, ChunkHeader& header, const char*& data, int& length) {
+    if (!readHeader(message, ChunkMagic, header)) return false;
+    data = message.constData() + sizeof(header);
+    length = message.size() - static_cast<int>(sizeof(header));
+    return true;
+}
+
+QByteArray WorldSyncFormat::encodeEnd(quint32 syncId) {
+    EndHeader header;
+    std::memcpy(header.magic, EndMagic, sizeof(header.magic));
+    header.version = Version;
+    header.reserved = 0;
+    header.syncId = syncId;
+
+    QByteArray message;
+    appendRaw(message, header);
+    return message;
+}
+
+bool WorldSyncFormat::decodeEnd(const QByteArray& message, quint32& syncId) {
+    EndHeader header;
+    if (!readHeader(message, EndMagic, header)) return false;
+    syncId = header.syncId;
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef WORLDSYNC_H
+#define WORLDSYNC_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QtGlobal>
+#include <string>
+#include <vector>
+
+// Initial world sync for a client that joins, binary WebSocket messages in
+// host order (little-endian):
+//
+//   begin    BeginHeader, then per profile
+//            quint32 packedSize, quint16 idLength, id
+//   chunk    ChunkHeader, then up to ChunkSize bytes of one packed profile
+//   end      EndHeader
+//
+// A packed profile is ProfileCategaory::toJson, compact, run through
+// qCompress. Every profile is captured when the sync begins and then sent
+// in chunks at the pace the client's queue allows, so the client can apply
+// each profile as soon as its last chunk arrives. Reliable changes the
+// server sends meanwhile describe the world after the capture; the client
+// holds them back until the end message and replays them on top.
+namespace WorldSyncFormat {
+
+const char BeginMagic[2] = {'W', 'B'};
+const char ChunkMagic[2] = {'W', 'C'};
+const char EndMagic[2] = {'W', 'E'};
+const quint8 Version = 1;
+const int ChunkSize = 60 * 1024;
+
+#pragma pack(push, 1)
+struct BeginHeader {
+    char magic[2];
+    quint8 version;
+    quint8 reserved;
+    quint32 syncId;       // changes with every sync a server starts
+    quint32 profileCount;
+    quint64 totalBytes;   // packed, all profiles
+};
+
+struct ChunkHeader {
+    char magic[2];
+    quint8 version;
+    quint8 reserved;
+    quint32 syncId;
+    quint32 profile;      // position in the begin message
+    quint32 offset;       // into the packed profile
+};
+
+struct EndHeader {
+    char magic[2];
+    quint8 version;
+    quint8 reserved;
+    quint32 syncId;
+};
+#pragma pack(pop)
+
+struct ProfileEntry {
+    std::string id;
+    quint32 packedSize = 0;
+};
+
+QByteArray packProfile(const QJsonObject& profile);
+bool unpackProfile(const QByteArray& packed, QJsonObject& out);
+
+QByteArray encodeBegin(quint32 syncId, const std::vector<ProfileEntry>& profiles);
+bool decodeBegin(const QByteArray& message, quint32& syncId, std::vector<ProfileEntry>& out);
+QByteArray encodeChunk(quint32 syncId, quint32 profile, quint32 offset, const char* data, int length);
+// data points into message
+bool decodeChunk(const QByteArray& message, ChunkHeader& header, const char*& data, int& length);
+QByteArray encodeEnd(quint32 syncId);
+bool decodeEnd(const QByteArray& message, quint32& syncId);
+
+}
+
+#endif // WORLDSYNC_H
@@ -1,6 +1,7 @@
 #include "recorder.h"
 #include "core/Hierarchy/hierarchy.h"
 #include "core/Simulation/simulation.h"
+#include "core/Hierarchy/EntityProfiles/platform.h"
 
 #include <QDebug>
 #include <QDir>
@@ -10,6 +11,7 @@
 #include <QFileInfo>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <algorithm>
 
 // Constructor: Initializes recorder with hierarchy and simulation pointers
 Recorder::Recorder(Hierarchy* hierarchy, Simulation* simulation, QObject *parent)
@@ -24,6 +26,7 @@ Recorder::Recorder(Hierarchy* hierarchy, Simulation* simulation, QObject *parent
         connect(m_simulation, &Simulation::speedUpdated, this, [=](int rate) {
             setRate(rate);
         });
+        m_simulation->recorder = this;
     }
 }
 QJsonObject Recorder::getAllRecordings() const
@@ -50,42 +53,51 @@ QJsonObject Recorder::getAllRecordings() const
 // }
 void Recorder::startRecording()
 {
-    qDebug() << "Recording started.";
-    clear();
-
-    if (!m_hierarchy) {
-        qWarning() << "Hierarchy is null. Cannot record.";
+    if (!m_simulation) {
+        qWarning() << "Simulation is null. Cannot record.";
         return;
     }
 
-    // Initial snapshot
-    //QJsonObject jsonData = m_hierarchy->toJson();
-    //jsonData["recording_rate"] = getRate();
-    //record(jsonData);
-
-    // Start recording time
-    recordingStartTime = QDateTime::currentDateTime();
+    startRecording(defaultRecordingPath(), 1.0 / m_simulation->PhysicsUpdateFrameRate);
+}
 
-    // Create timer if not already created
-    if (!recordingTimer) {
-        recordingTimer = new QTimer(this);
+QString Recorder::defaultRecordingPath()
+{
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/recordings";
+    QDir().mkpath(directory); // ensure directory exists
+    return directory + "/recorder" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".tdfr";
+}
 
-        connect(recordingTimer, &QTimer::timeout, this, [this]() {
-            qint64 elapsedMs = recordingStartTime.msecsTo(QDateTime::currentDateTime());
+// Opens a binary recording (see recordingformat.h). The scenario is stored
+// once in the header; from then on Simulation hands every tick to
+// captureTick, so nothing is serialized while no recording is open.
+bool Recorder::startRecording(const QString &filePath, double timeStep, int tickInterval,
+                              const RecordingEncoding &encoding)
+{
+    if (isRecording()) stopRecording();
+    resetRecording();
 
-            QJsonObject timeEntry;
-            timeEntry["timestamp_ms"] = elapsedMs;
-            timeEntry["current_time"] = QDateTime::currentDateTime().toString(Qt::ISODate);
-            timeEntry["snapshot"] = m_hierarchy->toJson();
+    if (!m_hierarchy) {
+        qWarning() << "Hierarchy is null. Cannot record.";
+        return false;
+    }
 
-            record(timeEntry);
+    const QByteArray scenario = QJsonDocument(m_hierarchy->toJson()).toJson(QJsonDocument::Compact);
+    m_tickInterval = std::max(1, tickInterval);
+    if (!m_stream.open(filePath, scenario, timeStep * m_tickInterval, encoding)) return false;
 
-            qDebug() << "Recorded interval at" << elapsedMs << "ms";
-        });
+    m_recordingPath = filePath;
+    m_slotIds.clear();
+    m_componentSlots.clear();
+    m_slotOrderRevision = ~0ull;
+    m_lastEventFlush = m_simulation ? m_simulation->simulatedTime() : 0;
+    // Track deltas are only delivered while a recording is open
+    if (m_simulation) {
+        m_trackEvents = connect(m_simulation, &Simulation::sensorTracksChanged, this, &Recorder::recordTrackDeltas);
     }
-
-    int intervalMs = 100; // record every 1 second
-    recordingTimer->start(intervalMs);
+    recordingStartTime = QDateTime::currentDateTime();
+    qDebug() << "Recording started:" << filePath;
+    return true;
 }
 
 
@@ -98,30 +110,86 @@ void Recorder::stopRecording()
 {
     qDebug() << "Recording stopped.";
 
-    // Stop and delete the interval timer if it exists
-    if (recordingTimer) {
-        recordingTimer->stop();
-        recordingTimer->deleteLater();
-        recordingTimer = nullptr;
-    }
-
     // Reset recording start time
     recordingStartTime = QDateTime();
 
-    // Display the entire JSON recording
-    if (!m_recordings.isEmpty()) {
-        QJsonDocument doc(m_recordings);
-        QString jsonString = doc.toJson(QJsonDocument::Indented); // Pretty print
-        qDebug() << "Full Recording JSON:\n" << jsonString;
-    } else {
-        qDebug() << "No recordings to display.";
+    disconnect(m_trackEvents);
+    if (isRecording()) {
+        flushTrackEvents();
+        m_stream.close();
+        const RecordingStreamStats stats = m_stream.streamStats();
+        qDebug() << "Recording written to" << m_recordingPath << "(" << stats.bytesWritten << "bytes,"
+                 << stats.stalls << "queue stalls, high water" << stats.highWater << "of" << stats.capacity << ")";
+    }
+}
+
+// One row per entity with a transform. Slots are handed out by entity ID
+// and only looked up again when Simulation reorders its components.
+void Recorder::captureTick(const std::vector<PhysicsComponent*> &components)
+{
+    const qint64 tick = m_simulation->tickCount();
+    if (tick % m_tickInterval != 0) return;
+
+    if (m_slotOrderRevision != m_simulation->componentOrderRevision()) {
+        m_slotOrderRevision = m_simulation->componentOrderRevision();
+        m_componentSlots.assign(components.size(), 0);
+        for (size_t i = 0; i < components.size(); ++i) {
+            const PhysicsComponent* comp = components[i];
+            auto it = m_slotIds.find(comp->entity->ID);
+            if (it == m_slotIds.end()) {
+                it = m_slotIds.emplace(comp->entity->ID, static_cast<quint32>(m_slotIds.size())).first;
+                m_stream.defineEntity(it->second, comp->entity->ID, comp->entity->Name);
+            }
+            m_componentSlots[i] = it->second;
+        }
+    }
+
+    const double time = m_simulation->simulatedTime();
+    m_stream.beginTick(tick, time, m_simulation->stateHash(), m_simulation->isDeterministic());
+    for (size_t i = 0; i < components.size(); ++i) {
+        const PhysicsComponent* comp = components[i];
+        if (!comp->transform) continue;
+        const QVector3D velocity = comp->rigidbody
+            ? QVector3D(comp->rigidbody->velocity->x, comp->rigidbody->velocity->y, comp->rigidbody->velocity->z)
+            : QVector3D();
+        m_stream.addRow(m_componentSlots[i], comp->transform->translation(), comp->transform->rotation(), velocity);
     }
+    m_stream.endTick();
 
-    qDebug() << "Recorder cleanup done.";
+    // Track events go out about once per simulated second
+    if (!pendingTrackEvents.isEmpty() && time - m_lastEventFlush >= 1.0) {
+        flushTrackEvents();
+        m_lastEventFlush = time;
+    }
 }
 
+void Recorder::flushTrackEvents()
+{
+    if (pendingTrackEvents.isEmpty()) return;
+    m_stream.writeEvents(QJsonDocument(pendingTrackEvents).toJson(QJsonDocument::Compact));
+    pendingTrackEvents = QJsonArray();
+}
 
 
+// Only entered/lost are kept: per-tick updates are already implied by the
+// recorded positions
+void Recorder::recordTrackDeltas(Sensor* sensor, const std::vector<TrackDelta>& deltas)
+{
+    if (!isRecording()) return;
+    for (const TrackDelta &delta : deltas) {
+        if (delta.kind == TrackDelta::Updated) continue;
+        QJsonObject event;
+        event["tick"] = m_simulation ? m_simulation->tickCount() : 0;
+        event["time"] = m_simulation ? m_simulation->simulatedTime() : 0.0;
+        event["sensor"] = QString::fromStdString(sensor->ID);
+        event["target"] = QString::fromStdString(delta.targetId);
+        event["kind"] = delta.kind == TrackDelta::Entered ? "entered" : "lost";
+        event["ew"] = delta.ew;
+        event["angle"] = delta.angle;
+        event["radius"] = delta.radius;
+        pendingTrackEvents.append(event);
+    }
+}
 
 // Convert hierarchy to JSON and save it to file
 void Recorder::recordToJson()
@@ -179,19 +247,50 @@ void Recorder::recordFrame(const QJsonObject &frame)
 // }
 bool Recorder::saveToFile()
 {
+    QString finalPath = saveToFile(QString());
+    if (finalPath.isEmpty()) return false;
+
+    // Optionally open the folder containing the file
+    QDesktopServices::openUrl(QUrl::fromLocalFile(QFileInfo(finalPath).absolutePath()));
+
+    return true;
+}
+
+// Write the recording without any UI; an empty path picks the default
+// timestamped file in the recordings folder. Returns the written path.
+QString Recorder::saveToFile(const QString &filePath)
+{
+    // The binary recording is already on disk; copy it if another path is asked for
+    if (!m_recordingPath.isEmpty() && !isRecording()) {
+        if (filePath.isEmpty() || QFileInfo(filePath) == QFileInfo(m_recordingPath)) {
+            qDebug() << "Recording saved to:" << m_recordingPath;
+            return m_recordingPath;
+        }
+        QFile::remove(filePath);
+        if (!QFile::copy(m_recordingPath, filePath)) {
+            qWarning() << "Failed to copy recording to:" << filePath;
+            return QString();
+        }
+        qDebug() << "Recording saved to:" << filePath;
+        return filePath;
+    }
+
     if (m_recordings.isEmpty()) {
         qWarning() << "No recordings to save!";
-        return false;
+        return QString();
+    }
+    QString finalPath = filePath;
+    if (finalPath.isEmpty()) {
+        QString directory = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/recordings";
+        QDir().mkpath(directory); // ensure directory exists
+        // Build file path with timestamp
+        finalPath = directory + "/recorder" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".json";
     }
-    QString directory = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/recordings";
-    QDir().mkpath(directory); // ensure directory exists
-    // Build file path with timestamp
-    QString finalPath = directory + "/recorder" + QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss") + ".json";
 
     QFile file(finalPath);
     if (!file.open(QIODevice::WriteOnly)) {
         qWarning() << "Failed to open file for saving:" << finalPath;
-        return false;
+        return QString();
     }
 
     // Convert recorded snapshots to JSON document
@@ -202,11 +301,7 @@ bool Recorder::saveToFile()
     file.close();
 
     qDebug() << "Recording saved to:" << finalPath;
-
-    // Optionally open the folder containing the file
-    QDesktopServices::openUrl(QUrl::fromLocalFile(QFileInfo(finalPath).absolutePath()));
-
-    return true;
+    return finalPath;
 }
 
 
@@ -289,6 +384,12 @@ bool Recorder::loadFromFile(const QString &filePath)
         return false;
     }
 
+    if (file.peek(sizeof(RecordingFormat::Magic)) == QByteArray(RecordingFormat::Magic, sizeof(RecordingFormat::Magic))) {
+        file.close();
+        return loadBinary(filePath);
+    }
+    m_reader.close();
+
     QByteArray data = file.readAll();
     file.close();
 
@@ -434,6 +535,100 @@ bool Recorder::loadFromFile(const QString &filePath)
 //     return true;
 // }
 
+// Maps the recording onto the live hierarchy and plays it from the start.
+// Only the index is read here; frames are decoded a chunk at a time as the
+// playhead reaches them, so opening and seeking cost the same at any length.
+bool Recorder::loadBinary(const QString &filePath)
+{
+    if (playbackTimer) playbackTimer->stop();
+    if (!m_reader.open(filePath)) return false;
+
+    bindReplayTargets();
+    if (std::none_of(m_replayTargets.begin(), m_replayTargets.end(), [](Platform* p) { return p != nullptr; })) {
+        // Recorded entities are not in the open scenario: load the one stored with the recording
+        m_hierarchy->fromJson(QJsonDocument::fromJson(m_reader.scenario()).object());
+        bindReplayTargets();
+    }
+
+    qDebug() << "Loaded recording" << filePath << "with" << m_reader.chunkCount() << "chunks,"
+             << replayDuration() << "s";
+    emit replayLoaded(replayDuration());
+    seekTo(0);
+    playReplay();
+    return true;
+}
+
+// The replay clock runs on wall time scaled by the speed factor and is
+// independent of the recorded tick rate: every UI frame samples the
+// recording once at the clock time, so 0.25x interpolates smoothly and 16x
+// jumps straight to the sample it needs.
+void Recorder::playReplay()
+{
+    if (!m_reader.isOpen()) return;
+    if (!playbackTimer) {
+        playbackTimer = new QTimer(this);
+        playbackTimer->setTimerType(Qt::PreciseTimer);
+        connect(playbackTimer, &QTimer::timeout, this, &Recorder::advanceReplay);
+    }
+    const int frameRate = m_simulation && m_simulation->UIUpdateFrameRate > 0 ? m_simulation->UIUpdateFrameRate : 60;
+    m_replayClock.start();
+    m_replayClockNs = 0;
+    playbackTimer->start(1000 / frameRate);
+}
+
+void Recorder::pauseReplay()
+{
+    if (playbackTimer) playbackTimer->stop();
+}
+
+void Recorder::setReplaySpeed(double speed)
+{
+    m_replaySpeed = speed;
+}
+
+void Recorder::advanceReplay()
+{
+    const qint64 now = m_replayClock.nsecsElapsed();
+    const double wallSeconds = (now - m_replayClockNs) / 1e9;
+    m_replayClockNs = now;
+
+    seekTo(m_replayPosition + wallSeconds * m_replaySpeed);
+    if ((m_replaySpeed >= 0 && m_replayPosition >= replayDuration()) || (m_replaySpeed < 0 && m_replayPosition <= 0)) {
+        playbackTimer->stop();
+        qDebug() << "Playback completed.";
+    }
+}
+
+void Recorder::bindReplayTargets()
+{
+    m_replayTargets.assign(m_reader.entityCount(), nullptr);
+    for (int slot = 0; slot < m_reader.entityCount(); ++slot) {
+        auto it = m_hierarchy->Entities->find(m_reader.entityId(slot));
+        if (it != m_hierarchy->Entities->end()) m_replayTargets[slot] = dynamic_cast<Platform*>(it->second);
+    }
+}
+
+// Reconstructs the recorded state at the given time from the nearest
+// keyframe, interpolated between the samples around it, and pushes it into
+// the hierarchy transforms
+bool Recorder::seekTo(double seconds)
+{
+    if (!m_reader.isOpen()) return false;
+    m_replayPosition = qBound(0.0, seconds, replayDuration());
+    if (!m_reader.sampleAt(m_reader.startTime() + m_replayPosition, m_replayFrame)) return false;
+
+    for (size_t i = 0; i < m_replayFrame.slots.size(); ++i) {
+        const quint32 slot = m_replayFrame.slots[i];
+        Platform* platform = slot < m_replayTargets.size() ? m_replayTargets[slot] : nullptr;
+        if (!platform || !platform->transform) continue;
+        platform->transform->setTranslation(m_replayFrame.positions[i]);
+        platform->transform->setRotation(m_replayFrame.orientations[i].normalized());
+    }
+    if (m_simulation) m_simulation->refreshViews();
+    emit replayPositionChanged(m_replayPosition);
+    return true;
+}
+
 QJsonValue Recorder::getArrayElement(const QJsonArray &array, int index)
 {
     if (array.isEmpty()) {
@@ -477,6 +672,7 @@ void Recorder::startReplay()
 void Recorder::stopReplay()
 {
     replayTimer->stop();
+    if (playbackTimer) playbackTimer->stop();
     currentFrame = 0;
     qDebug() << "Replay stopped.";
 }
@@ -507,6 +703,15 @@ void Recorder::clear()
     currentFrame = 0;
 }
 
+// Drops everything a previous recording left behind before a new one opens
+void Recorder::resetRecording()
+{
+    clear();
+    m_recordings = QJsonArray();
+    pendingTrackEvents = QJsonArray();
+    m_recordingPath.clear();
+}
+
 // Set the sample rate for recording
 void Recorder::setRate(int rate)
 {
@@ -67,10 +67,21 @@
 #include <QJsonDocument>
 #include <QTimer>
 #include <QJsonValue>
+#include <QElapsedTimer>
+#include <core/Recorder/recordingreader.h>
+#include <core/Recorder/recordingstream.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 // Forward declarations to avoid circular includes
 class Hierarchy;
 class Simulation;
+class Sensor;
+class Platform;
+struct TrackDelta;
+struct PhysicsComponent;
 
 class Recorder : public QObject
 {
@@ -80,12 +91,22 @@ public:
     // Constructor:Accepts hierarchy and simulation to pull state and recording speed
     explicit Recorder(Hierarchy* hierarchy, Simulation* simulation, QObject *parent = nullptr);
     QJsonObject getAllRecordings() const;
-    void startRecording();
+    void startRecording();  // binary recording in the default recordings folder
+    bool startRecording(const QString &filePath, double timeStep, int tickInterval = 1,
+                        const RecordingEncoding &encoding = RecordingEncoding());
+    static QString defaultRecordingPath();  // timestamped .tdfr in Documents/recordings
     void stopRecording();
+    bool isRecording() const { return m_stream.isOpen(); }
+    QString recordingPath() const { return m_recordingPath; }
+    const RecordingStats &recordingStats() const { return m_stream.stats(); }  // complete after stopRecording
+    RecordingStreamStats streamStats() const { return m_stream.streamStats(); }  // writer queue backpressure
+    void captureTick(const std::vector<PhysicsComponent*> &components); // called by Simulation after every tick while recording
     void recordToJson();
     void record(const QJsonObject &data);       // Store entire JSON data
     void recordFrame(const QJsonObject &frame); // Store individual frame
+    void recordTrackDeltas(Sensor* sensor, const std::vector<TrackDelta>& deltas); // Queue track gains/losses for the next event block
     bool saveToFile();
+    QString saveToFile(const QString &filePath);
     bool loadFromFile(const QString &filePath);
     void clear();  // Clears previously recorded dataz
 
@@ -95,10 +116,23 @@ public:
     void startReplay();
     void stopReplay();
 
+    // Binary recordings loaded by loadFromFile; times are seconds from the first sample
+    bool hasReplay() const { return m_reader.isOpen(); }
+    double replayDuration() const { return m_reader.duration(); }
+    double replayPosition() const { return m_replayPosition; }
+    bool seekTo(double seconds);
+    void playReplay();
+    void pauseReplay();
+    bool isReplayPlaying() const { return playbackTimer && playbackTimer->isActive(); }
+    double replaySpeed() const { return m_replaySpeed; }
+    void setReplaySpeed(double speed);  // any factor; negative plays backwards
+
     QVector<QJsonObject> getRecordedFrames() const;
 
 signals:
     void replayFrame(QJsonObject frame);
+    void replayLoaded(double durationSeconds);
+    void replayPositionChanged(double seconds);
 
 private slots:
     void playNextFrame();
@@ -119,6 +153,30 @@ private:
     QTimer *recordingTimer = nullptr; // Timer to store intervals
     QJsonArray m_recordings;
     //End Hima
+    QJsonArray pendingTrackEvents;  // Track events since the last event block
+    QMetaObject::Connection m_trackEvents;  // sensorTracksChanged, while recording
+
+    void flushTrackEvents();
+    void resetRecording();
+    RecordingStream m_stream;  // encodes and writes on its own thread
+    QString m_recordingPath;  // last binary recording, kept after stopRecording
+    int m_tickInterval = 1;   // record every Nth simulation tick
+    double m_lastEventFlush = 0;
+    std::unordered_map<std::string, quint32> m_slotIds;  // entity ID -> recording slot, stable for the session
+    std::vector<quint32> m_componentSlots;               // slot per component of the last seen order
+    quint64 m_slotOrderRevision = 0;
+
+    bool loadBinary(const QString &filePath);
+    void bindReplayTargets();
+    RecordingReader m_reader;
+    RecordingFrame m_replayFrame;
+    std::vector<Platform*> m_replayTargets;  // by recording slot, nullptr when absent
+    QTimer *playbackTimer = nullptr;  // one tick per UI frame while playing
+    QElapsedTimer m_replayClock;
+    qint64 m_replayClockNs = 0;
+    double m_replayPosition = 0;
+    double m_replaySpeed = 1.0;
+    void advanceReplay();
 };
 
 #endif // RECORDER_H
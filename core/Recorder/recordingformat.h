@@ -0,0 +1,137 @@
+#ifndef RECORDINGFORMAT_H
+#define RECORDINGFORMAT_H
+
+#include <QtGlobal>
+
+// On-disk layout of a binary recording (.tdfr), little-endian throughout:
+//
+//   FileHeader, scenario JSON (scenarioSize bytes)
+//   Block*       BlockHeader + payload; entity, frame and event blocks
+//   Block 'I'    the chunk index: IndexEntry[count]
+//   Trailer      offset of the index block
+//
+// A frame block holds up to ChunkTicks consecutive ticks for one fixed set
+// of entity slots. Its first tick is a full-precision keyframe; later ticks
+// only carry quantised deltas for the entities that moved by more than the
+// steps in the FileHeader. The body is zlib compressed (qCompress), so each
+// chunk decodes on its own without any earlier data. The index also keeps
+// each chunk's position bounding box, so spatial queries can skip chunks
+// without decompressing them.
+namespace RecordingFormat {
+
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "recordings are written in host order");
+
+const char Magic[4] = {'T', 'D', 'F', 'R'};
+const char IndexMagic[4] = {'T', 'D', 'F', 'I'};
+const quint32 Version = 3;
+const int ChunkTicks = 256; // also the keyframe interval
+
+enum BlockType : quint32 {
+    EntityBlock = 'S', // slot -> entity id/name definitions
+    FrameBlock = 'F',  // one chunk of per-tick columns
+    EventBlock = 'E',  // compact JSON array of track events
+    IndexBlock = 'I'
+};
+
+enum ChunkFlags : quint32 {
+    HasStateHash = 1, // a quint64 lockstep hash per tick follows the times
+    Compressed = 2    // the body after the ChunkHeader is qCompress output
+};
+
+enum DeltaFields : quint8 {
+    PositionDelta = 1,
+    OrientationDelta = 2,
+    VelocityDelta = 4
+};
+
+// Default quantisation steps, also the largest replay error per component
+const float PositionStep = 0.001f;    // metres
+const float OrientationStep = 0.0001f; // quaternion component
+const float VelocityStep = 0.001f;    // metres per second
+
+// Shared by writer and replay so both reconstruct bit-identical values
+inline float applyDelta(float value, qint32 steps, float step) {
+    return value + static_cast<float>(steps) * step;
+}
+
+#pragma pack(push, 1)
+struct FileHeader {
+    char magic[4];
+    quint32 version;
+    double timeStep;      // simulated seconds per tick
+    quint64 scenarioSize; // bytes of hierarchy JSON that follow
+    float positionStep;   // delta quantisation steps
+    float orientationStep;
+    float velocityStep;
+    quint32 reserved;
+};
+
+struct BlockHeader {
+    quint32 type;
+    quint32 reserved;
+    quint64 payloadSize;
+};
+
+// EntityBlock payload: quint32 count, then per entity
+//   quint32 slot, quint16 idLength, id, quint16 nameLength, name
+
+// FrameBlock payload: ChunkHeader, then the body
+//   quint32 slots[entityCount]
+//   double  times[tickCount]
+//   quint64 hashes[tickCount]                     (HasStateHash only)
+//   keyframe, first tick only:
+//     float positions[entityCount][3]
+//     float orientations[entityCount][4]          (scalar, x, y, z)
+//     float velocities[entityCount][3]
+//   per following tick:
+//     quint32 changedCount, then per changed entity
+//       quint32 row, quint8 DeltaFields mask,
+//       qint32 steps for each field in the mask (3, 4 and 3 values)
+// Replay adds steps * step to the previous decoded value in float, exactly
+// as the writer does, so the error never accumulates past half a step.
+struct ChunkHeader {
+    qint64 firstTick;
+    quint32 tickCount;
+    quint32 entityCount;
+    quint32 flags;
+    quint32 bodySize; // uncompressed
+};
+
+// IndexBlock payload: quint32 count, then IndexEntry[count]
+struct IndexEntry {
+    quint32 type;
+    quint32 tickCount;
+    qint64 firstTick;
+    double firstTime;
+    double lastTime;
+    quint64 offset; // of the BlockHeader
+    quint64 size;   // header plus payload
+    float boundsMin[3]; // frame blocks: box around every decoded position
+    float boundsMax[3];
+};
+
+struct Trailer {
+    quint64 indexOffset;
+    char magic[4];
+    quint32 version;
+};
+#pragma pack(pop)
+
+// Bounding box accumulation shared by the writer and the block scan
+inline void clearBounds(float* min, float* max) {
+    for (int c = 0; c < 3; ++c) {
+        min[c] = 3.4e38f;
+        max[c] = -3.4e38f;
+    }
+}
+
+inline void extendBounds(float* min, float* max, const float* position) {
+    for (int c = 0; c < 3; ++c) {
+        if (position[c] < min[c]) min[c] = position[c];
+        if (position[c] > max[c]) max[c] = position[c];
+    }
+}
+
+}
+
+#endif // RECORDINGFORMAT_H
@@ -0,0 +1,374 @@
+#include "recordingquery.h"
+#include <core/Simulation/jobsystem.h>
+#include <core/Debug/console.h>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <algorithm>
+#include <map>
+
+using namespace RecordingFormat;
+
+namespace {
+// Relative positions of A and B at one sample, for joining chunk edges
+struct ApproachSample {
+    double time = 0.0;
+    QVector3D a, b;
+};
+
+struct ChunkApproach {
+    int chunk = -1;
+    RecordingApproach best;
+    bool hasSamples = false;
+    ApproachSample first, last;
+};
+
+// Closest point of two linear motions between samples p and q
+void closestBetween(const ApproachSample& p, const ApproachSample& q, RecordingApproach& best) {
+    const QVector3D r0 = p.b - p.a;
+    const QVector3D dr = (q.b - q.a) - r0;
+    const float speed = dr.lengthSquared();
+    float s = speed > 0.0f ? -QVector3D::dotProduct(r0, dr) / speed : 0.0f;
+    s = std::max(0.0f, std::min(1.0f, s));
+    const double distance = (r0 + dr * s).length();
+    if (!best.found || distance < best.distance) {
+        best.found = true;
+        best.distance = distance;
+        best.time = p.time + s * (q.time - p.time);
+        best.positionA = p.a + (q.a - p.a) * s;
+        best.positionB = p.b + (q.b - p.b) * s;
+    }
+}
+
+int findRow(const RecordingChunk& chunk, quint32 slot) {
+    auto it = std::find(chunk.slots.begin(), chunk.slots.end(), slot);
+    return it == chunk.slots.end() ? -1 : static_cast<int>(it - chunk.slots.begin());
+}
+
+QVector3D positionAt(const RecordingChunk& chunk, int tick, int row) {
+    const float* p = &chunk.positions[(tick * chunk.entityCount() + row) * 3];
+    return QVector3D(p[0], p[1], p[2]);
+}
+
+bool parsePair(const QString& text, double& first, double& second, QChar separator) {
+    const QStringList parts = text.split(separator);
+    bool okFirst = false, okSecond = false;
+    if (parts.size() != 2) return false;
+    first = parts[0].trimmed().toDouble(&okFirst);
+    second = parts[1].trimmed().toDouble(&okSecond);
+    return okFirst && okSecond;
+}
+}
+
+bool RecordingRegion::contains(const QVector3D& position) const {
+    if (position.y() < minHeight || position.y() > maxHeight) return false;
+    if (radius > 0.0) {
+        const double dx = position.x() - center.x(), dz = position.z() - center.y();
+        return dx * dx + dz * dz <= radius * radius;
+    }
+    return polygon.containsPoint(QPointF(position.x(), position.z()), Qt::OddEvenFill);
+}
+
+bool RecordingRegion::intersects(const IndexEntry& chunk) const {
+    if (chunk.boundsMax[1] < minHeight || chunk.boundsMin[1] > maxHeight) return false;
+    const QRectF area = radius > 0.0 ? QRectF(center.x() - radius, center.y() - radius, 2 * radius, 2 * radius)
+                                     : polygon.boundingRect();
+    return chunk.boundsMax[0] >= area.left() && chunk.boundsMin[0] <= area.right() &&
+           chunk.boundsMax[2] >= area.top() && chunk.boundsMin[2] <= area.bottom();
+}
+
+bool RecordingRegion::parsePolygon(const QString& spec, RecordingRegion& out) {
+    out.polygon.clear();
+    out.radius = 0.0;
+    for (const QString& point : spec.split(';', Qt::SkipEmptyParts)) {
+        double x = 0, z = 0;
+        if (!parsePair(point, x, z, ',')) return false;
+        out.polygon << QPointF(x, z);
+    }
+    return out.polygon.size() >= 3;
+}
+
+bool RecordingRegion::parseCircle(const QString& spec, RecordingRegion& out) {
+    const QStringList parts = spec.split(',');
+    if (parts.size() != 3) return false;
+    bool okX = false, okZ = false, okRadius = false;
+    out.center = QPointF(parts[0].trimmed().toDouble(&okX), parts[1].trimmed().toDouble(&okZ));
+    out.radius = parts[2].trimmed().toDouble(&okRadius);
+    return okX && okZ && okRadius && out.radius > 0.0;
+}
+
+bool RecordingRegion::parseHeights(const QString& spec, RecordingRegion& out) {
+    return parsePair(spec, out.minHeight, out.maxHeight, ':') && out.minHeight <= out.maxHeight;
+}
+
+RecordingQuery::RecordingQuery(const RecordingReader& reader, int threadCount)
+    : m_reader(reader), m_jobs(new JobSystem(threadCount)) {}
+
+RecordingQuery::~RecordingQuery() = default;
+
+int RecordingQuery::resolve(const QString& entity) const {
+    const std::string key = entity.toStdString();
+    const int slot = m_reader.findSlot(key);
+    if (slot >= 0) return slot;
+    for (int i = 0; i < m_reader.entityCount(); ++i) {
+        if (m_reader.entityName(i) == key) return i;
+    }
+    return -1;
+}
+
+// Runs scan(chunkIndex, decodedChunk, result) on every chunk the time range
+// and region leave, results in chunk order
+template <typename Result, typename Scan>
+std::vector<Result> RecordingQuery::forEachChunk(double from, double to, const RecordingRegion* region, Scan scan) const {
+    int first = 0, last = 0;
+    m_reader.chunkRange(from, to, first, last);
+    std::vector<int> chunks;
+    for (int i = first; i < last; ++i) {
+        if (!region || region->intersects(m_reader.chunkEntry(i))) chunks.push_back(i);
+    }
+    m_scanned = static_cast<int>(chunks.size());
+    m_skipped = m_reader.chunkCount() - m_scanned;
+
+    std::vector<Result> results(chunks.size());
+    m_jobs->parallelFor(static_cast<int>(chunks.size()), 1, [&](int begin, int end) {
+        RecordingChunk chunk;
+        for (int i = begin; i < end; ++i) {
+            if (!m_reader.decodeChunk(chunks[i], chunk)) {
+                Console::error("RecordingQuery: chunk " + std::to_string(chunks[i]) + " is corrupt");
+                continue;
+            }
+            scan(chunks[i], chunk, results[i]);
+        }
+    });
+    return results;
+}
+
+std::vector<RecordingVisit> RecordingQuery::window(const RecordingRegion& region, double from, double to) const {
+    const auto perChunk = forEachChunk<std::vector<RecordingVisit>>(from, to, &region,
+        [&](int chunkIndex, const RecordingChunk& chunk, std::vector<RecordingVisit>& visits) {
+            // The last sample holds until the next chunk starts
+            const double chunkEnd = chunkIndex + 1 < m_reader.chunkCount() ? m_reader.chunkEntry(chunkIndex + 1).firstTime
+                                                                         : chunk.times.back();
+            for (int row = 0; row < chunk.entityCount(); ++row) {
+                bool inside = false;
+                RecordingVisit visit;
+                visit.slot = chunk.slots[row];
+                for (int t = 0; t < chunk.tickCount(); ++t) {
+                    const double time = chunk.times[t];
+                    const bool in = time >= from && time <= to && region.contains(positionAt(chunk, t, row));
+                    if (in && !inside) visit.enter = time;
+                    if (!in && inside) {
+                        visit.exit = std::min(time, to);
+                        visits.push_back(visit);
+                    }
+                    inside = in;
+                }
+                if (inside) {
+                    visit.exit = std::min(chunkEnd, to);
+                    visits.push_back(visit);
+                }
+            }
+        });
+
+    // Stays that run over a chunk edge continue in the next chunk
+    std::vector<RecordingVisit> visits;
+    for (const std::vector<RecordingVisit>& chunkVisits : perChunk) visits.insert(visits.end(), chunkVisits.begin(), chunkVisits.end());
+    std::sort(visits.begin(), visits.end(), [](const RecordingVisit& a, const RecordingVisit& b) {
+        return a.slot != b.slot ? a.slot < b.slot : a.enter < b.enter;
+    });
+    std::vector<RecordingVisit> merged;
+    for (const RecordingVisit& visit : visits) {
+        if (!merged.empty() && merged.back().slot == visit.slot && visit.enter <= merged.back().exit) {
+            merged.back().exit = std::max(merged.back().exit, visit.exit);
+        } else {
+            merged.push_back(visit);
+        }
+    }
+    return merged;
+}
+
+std::vector<RecordingDwell> RecordingQuery::timeAtLocation(const RecordingRegion& region, double from, double to) const {
+    std::map<quint32, RecordingDwell> bySlot;
+    for (const RecordingVisit& visit : window(region, from, to)) {
+        RecordingDwell& dwell = bySlot[visit.slot];
+        dwell.slot = visit.slot;
+        dwell.seconds += visit.exit - visit.enter;
+        dwell.visits++;
+    }
+    std::vector<RecordingDwell> dwells;
+    for (const auto& entry : bySlot) dwells.push_back(entry.second);
+    std::sort(dwells.begin(), dwells.end(), [](const RecordingDwell& a, const RecordingDwell& b) {
+        return a.seconds > b.seconds;
+    });
+    return dwells;
+}
+
+RecordingApproach RecordingQuery::nearestApproach(quint32 slotA, quint32 slotB, double from, double to) const {
+    const auto perChunk = forEachChunk<ChunkApproach>(from, to, nullptr,
+        [&](int chunkIndex, const RecordingChunk& chunk, ChunkApproach& result) {
+            result.chunk = chunkIndex;
+            const int rowA = findRow(chunk, slotA), rowB = findRow(chunk, slotB);
+            if (rowA < 0 || rowB < 0) return;
+            ApproachSample previous;
+            for (int t = 0; t < chunk.tickCount(); ++t) {
+                if (chunk.times[t] < from || chunk.times[t] > to) continue;
+                const ApproachSample sample{chunk.times[t], positionAt(chunk, t, rowA), positionAt(chunk, t, rowB)};
+                if (!result.hasSamples) {
+                    result.first = sample;
+                    closestBetween(sample, sample, result.best);
+                } else {
+                    closestBetween(previous, sample, result.best);
+                }
+                result.hasSamples = true;
+                previous = sample;
+            }
+            result.last = previous;
+        });
+
+    // Segments between neighbouring chunks are checked here
+    RecordingApproach best;
+    const ChunkApproach* previous = nullptr;
+    for (const ChunkApproach& chunk : perChunk) {
+        if (!chunk.hasSamples) {
+            previous = nullptr;
+            continue;
+        }
+        if (chunk.best.found && (!best.found || chunk.best.distance < best.distance)) best = chunk.best;
+        if (previous && previous->chunk + 1 == chunk.chunk) closestBetween(previous->last, chunk.first, best);
+        previous = &chunk;
+    }
+    return best;
+}
+
+std::vector<RecordingTrackPoint> RecordingQuery::track(quint32 slot, double from, double to) const {
+    const auto perChunk = forEachChunk<std::vector<RecordingTrackPoint>>(from, to, nullptr,
+        [&](int, const RecordingChunk& chunk, std::vector<RecordingTrackPoint>& points) {
+            const int row = findRow(chunk, slot);
+            if (row < 0) return;
+            const size_t n = chunk.slots.size();
+            for (int t = 0; t < chunk.tickCount(); ++t) {
+                if (chunk.times[t] < from || chunk.times[t] > to) continue;
+                const size_t index = t * n + row;
+                const float* q = &chunk.orientations[index * 4];
+                const float* v = &chunk.velocities[index * 3];
+                RecordingTrackPoint point;
+                point.time = chunk.times[t];
+                point.position = positionAt(chunk, t, row);
+                point.orientation = QQuaternion(q[0], q[1], q[2], q[3]);
+                point.velocity = QVector3D(v[0], v[1], v[2]);
+                points.push_back(point);
+            }
+        });
+
+    std::vector<RecordingTrackPoint> points;
+    for (const std::vector<RecordingTrackPoint>& chunkPoints : perChunk) points.insert(points.end(), chunkPoints.begin(), chunkPoints.end());
+    return points;
+}
+
+static std::string entityLabel(const RecordingReader& reader, quint32 slot) {
+    return reader.entityName(slot) + " (" + reader.entityId(slot) + ")";
+}
+
+int RecordingQuery::exec(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("TDF recording query");
+    parser.addHelpOption();
+    QCommandLineOption queryOption("query", "Recording (.tdfr) to query.", "recording");
+    QCommandLineOption windowOption("window", "Entities inside the ground polygon x,z;x,z;... and when they entered and left.", "polygon");
+    QCommandLineOption locationOption("location", "Time each entity spent within radius of x,z.", "x,z,radius");
+    QCommandLineOption heightsOption("heights", "Height band for --window and --location.", "min:max");
+    QCommandLineOption nearestOption("nearest", "Closest approach between two entities, by ID or name.", "A,B");
+    QCommandLineOption trackOption("track", "Recorded samples of one entity, by ID or name; --output writes them as CSV.", "entity");
+    QCommandLineOption fromOption("from", "Query start in recorded simulation seconds.", "seconds");
+    QCommandLineOption toOption("to", "Query end in recorded simulation seconds.", "seconds");
+    QCommandLineOption outputOption("output", "Track CSV file.", "file");
+    QCommandLineOption threadsOption("threads", "Chunk decoding threads (default: one per core).", "count", "-1");
+    parser.addOptions({queryOption, windowOption, locationOption, heightsOption, nearestOption, trackOption, fromOption,
+                       toOption, outputOption, threadsOption});
+    parser.process(arguments);
+
+    const QString window = parser.value(windowOption);
+    const QString location = parser.value(locationOption);
+    const QString heights = parser.value(heightsOption);
+    const QString nearest = parser.value(nearestOption);
+    const QString track = parser.value(trackOption);
+    const QString outputPath = parser.value(outputOption);
+    const double from = parser.isSet(fromOption) ? parser.value(fromOption).toDouble() : -1e300;
+    const double to = parser.isSet(toOption) ? parser.value(toOption).toDouble() : 1e300;
+
+    RecordingReader reader;
+    if (!reader.open(parser.value(queryOption))) return 1;
+    RecordingQuery query(reader, parser.value(threadsOption).toInt());
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!window.isEmpty() || !location.isEmpty()) {
+        RecordingRegion region;
+        const bool parsed = window.isEmpty() ? RecordingRegion::parseCircle(location, region)
+                                             : RecordingRegion::parsePolygon(window, region);
+        if (!parsed || (!heights.isEmpty() && !RecordingRegion::parseHeights(heights, region))) {
+            Console::error("RecordingQuery: bad --window, --location or --heights");
+            return 1;
+        }
+        if (!window.isEmpty()) {
+            const std::vector<RecordingVisit> visits = query.window(region, from, to);
+            for (const RecordingVisit& visit : visits) {
+                Console::log("  " + entityLabel(reader, visit.slot) + " inside " + std::to_string(visit.enter) +
+                             " - " + std::to_string(visit.exit) + " s");
+            }
+            Console::log("Window: " + std::to_string(visits.size()) + " visits");
+        } else {
+            const std::vector<RecordingDwell> dwells = query.timeAtLocation(region, from, to);
+            for (const RecordingDwell& dwell : dwells) {
+                Console::log("  " + entityLabel(reader, dwell.slot) + " " + std::to_string(dwell.seconds) + " s in " +
+                             std::to_string(dwell.visits) + " visits");
+            }
+            Console::log("Time at location: " + std::to_string(dwells.size()) + " entities");
+        }
+    } else if (!nearest.isEmpty()) {
+        const QStringList pair = nearest.split(',');
+        const int a = pair.size() == 2 ? query.resolve(pair[0].trimmed()) : -1;
+        const int b = pair.size() == 2 ? query.resolve(pair[1].trimmed()) : -1;
+        if (a < 0 || b < 0) {
+            Console::error("RecordingQuery: --nearest needs two recorded entities");
+            return 1;
+        }
+        const RecordingApproach approach = query.nearestApproach(a, b, from, to);
+        if (!approach.found) {
+            Console::log("Nearest approach: the entities were never recorded together");
+        } else {
+            Console::log("Nearest approach: " + std::to_string(approach.distance) + " m at " +
+                         std::to_string(approach.time) + " s");
+        }
+    } else if (!track.isEmpty()) {
+        const int slot = query.resolve(track);
+        if (slot < 0) {
+            Console::error("RecordingQuery: " + track.toStdString() + " is not in the recording");
+            return 1;
+        }
+        const std::vector<RecordingTrackPoint> points = query.track(slot, from, to);
+        QFile csv(outputPath);
+        if (!outputPath.isEmpty() && !csv.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            Console::error("RecordingQuery: failed to write " + outputPath.toStdString());
+            return 1;
+        }
+        if (csv.isOpen()) csv.write("time,x,y,z,qw,qx,qy,qz,vx,vy,vz\n");
+        for (const RecordingTrackPoint& p : points) {
+            const QString line = QString("%1,%2,%3,%4,%5,%6,%7,%8,%9,%10,%11")
+                .arg(p.time, 0, 'f', 4).arg(p.position.x()).arg(p.position.y()).arg(p.position.z())
+                .arg(p.orientation.scalar()).arg(p.orientation.x()).arg(p.orientation.y()).arg(p.orientation.z())
+                .arg(p.velocity.x()).arg(p.velocity.y()).arg(p.velocity.z());
+            if (csv.isOpen()) csv.write(line.toUtf8() + "\n");
+            else Console::log("  " + line.toStdString());
+        }
+        Console::log("Track " + entityLabel(reader, slot) + ": " + std::to_string(points.size()) + " samples");
+    } else {
+        Console::error("RecordingQuery: --query needs --window, --location, --nearest or --track");
+        return 1;
+    }
+
+    Console::log("Query scanned " + std::to_string(query.chunksScanned()) + " of " + std::to_string(reader.chunkCount()) +
+                 " chunks in " + std::to_string(timer.nsecsElapsed() / 1e6) + " ms");
+    return 0;
+}
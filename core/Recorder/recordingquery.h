@@ -0,0 +1,101 @@
+#ifndef RECORDINGQUERY_H
+#define RECORDINGQUERY_H
+
+#include <core/Recorder/recordingreader.h>
+#include <QPointF>
+#include <QPolygonF>
+#include <QRectF>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+
+class JobSystem;
+
+// Area of interest: a polygon or a circle on the ground plane (x, z) and a
+// height band on y
+struct RecordingRegion {
+    QPolygonF polygon;   // used when radius is 0
+    QPointF center;
+    double radius = 0.0;
+    double minHeight = -std::numeric_limits<double>::infinity();
+    double maxHeight = std::numeric_limits<double>::infinity();
+
+    bool contains(const QVector3D& position) const;
+    bool intersects(const RecordingFormat::IndexEntry& chunk) const; // false only when the chunk box is clear of it
+
+    // "x,z;x,z;x,z..." / "x,z,radius" / "min:max"
+    static bool parsePolygon(const QString& spec, RecordingRegion& out);
+    static bool parseCircle(const QString& spec, RecordingRegion& out);
+    static bool parseHeights(const QString& spec, RecordingRegion& out);
+};
+
+// One continuous stay inside a region. A sample inside counts until the
+// next sample, so exit is the first sample found outside.
+struct RecordingVisit {
+    quint32 slot = 0;
+    double enter = 0.0;
+    double exit = 0.0;
+};
+
+struct RecordingDwell {
+    quint32 slot = 0;
+    double seconds = 0.0;
+    int visits = 0;
+};
+
+// Closest approach between two entities, moving linearly between samples
+struct RecordingApproach {
+    bool found = false; // both entities were recorded at some common tick
+    double time = 0.0;
+    double distance = 0.0;
+    QVector3D positionA, positionB;
+};
+
+struct RecordingTrackPoint {
+    double time = 0.0;
+    QVector3D position;
+    QQuaternion orientation;
+    QVector3D velocity;
+};
+
+// Offline queries over one recording. Only chunks whose time span overlaps
+// the query are considered, spatial queries also drop chunks whose index
+// bounding box misses the region, and the rest are decoded and scanned in
+// parallel, one chunk per job. The reader is only used through its const,
+// thread-safe calls.
+class RecordingQuery
+{
+public:
+    explicit RecordingQuery(const RecordingReader& reader, int threadCount = -1);
+    ~RecordingQuery();
+
+    // Resolves an entity ID or name to its slot, -1 when not recorded
+    int resolve(const QString& entity) const;
+
+    std::vector<RecordingVisit> window(const RecordingRegion& region, double from, double to) const;
+    std::vector<RecordingDwell> timeAtLocation(const RecordingRegion& region, double from, double to) const;
+    RecordingApproach nearestApproach(quint32 slotA, quint32 slotB, double from, double to) const;
+    std::vector<RecordingTrackPoint> track(quint32 slot, double from, double to) const;
+
+    // "--query recording.tdfr" with --window, --location, --nearest or --track
+    // on the headless entry point
+    static int exec(const QStringList& arguments);
+
+    // Chunks decoded and skipped by the last query
+    int chunksScanned() const { return m_scanned; }
+    int chunksSkipped() const { return m_skipped; }
+
+private:
+    template <typename Result, typename Scan>
+    std::vector<Result> forEachChunk(double from, double to, const RecordingRegion* region, Scan scan) const;
+
+    const RecordingReader& m_reader;
+    std::unique_ptr<JobSystem> m_jobs;
+    mutable std::atomic<int> m_scanned{0};
+    mutable std::atomic<int> m_skipped{0};
+};
+
+#endif // RECORDINGQUERY_H
@@ -0,0 +1,417 @@
+#include "recordingreader.h"
+#include <core/Debug/console.h>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cstring>
+
+using namespace RecordingFormat;
+
+namespace {
+// Bounds-checked sequential reads over a block or chunk body
+struct Cursor {
+    const char* data;
+    size_t size;
+    size_t offset = 0;
+
+    bool read(void* out, size_t bytes) {
+        if (bytes > size - offset) return false;
+        std::memcpy(out, data + offset, bytes);
+        offset += bytes;
+        return true;
+    }
+    template <typename T>
+    bool read(T& out) { return read(&out, sizeof(T)); }
+    template <typename T>
+    bool readColumn(std::vector<T>& out, size_t count) {
+        out.resize(count);
+        return read(out.data(), count * sizeof(T));
+    }
+    bool readString(std::string& out) {
+        quint16 length = 0;
+        if (!read(length) || length > size - offset) return false;
+        out.assign(data + offset, length);
+        offset += length;
+        return true;
+    }
+};
+}
+
+void RecordingChunk::frame(int tick, RecordingFrame& out) const {
+    const size_t n = slots.size();
+    out.tick = firstTick + tick;
+    out.time = times[tick];
+    out.stateHash = hasHash ? hashes[tick] : 0;
+    out.slots = slots;
+    out.positions.resize(n);
+    out.orientations.resize(n);
+    out.velocities.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const size_t row = tick * n + i;
+        const float* p = &positions[row * 3];
+        const float* q = &orientations[row * 4];
+        const float* v = &velocities[row * 3];
+        out.positions[i] = QVector3D(p[0], p[1], p[2]);
+        out.orientations[i] = QQuaternion(q[0], q[1], q[2], q[3]);
+        out.velocities[i] = QVector3D(v[0], v[1], v[2]);
+    }
+}
+
+RecordingReader::~RecordingReader() {
+    close();
+}
+
+bool RecordingReader::open(const QString& path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        Console::error("RecordingReader: failed to open " + path.toStdString());
+        return false;
+    }
+    m_size = static_cast<quint64>(m_file.size());
+    m_data = m_size >= sizeof(FileHeader) ? m_file.map(0, m_file.size()) : nullptr;
+    if (!m_data) {
+        Console::error("RecordingReader: cannot map " + path.toStdString());
+        close();
+        return false;
+    }
+
+    std::memcpy(&m_header, m_data, sizeof(m_header));
+    if (std::memcmp(m_header.magic, Magic, sizeof(Magic)) != 0 || m_header.version != Version ||
+        m_header.scenarioSize > m_size - sizeof(FileHeader)) {
+        Console::error("RecordingReader: " + path.toStdString() + " is not a version " +
+                       std::to_string(Version) + " recording");
+        close();
+        return false;
+    }
+
+    if (!readIndex()) {
+        Console::warning("RecordingReader: " + path.toStdString() + " has no index (unfinished recording), scanning");
+        if (!scanBlocks()) {
+            close();
+            return false;
+        }
+    }
+    std::sort(m_chunks.begin(), m_chunks.end(), [](const IndexEntry& a, const IndexEntry& b) {
+        return a.firstTime < b.firstTime;
+    });
+    return true;
+}
+
+void RecordingReader::close() {
+    if (m_data) m_file.unmap(const_cast<uchar*>(m_data));
+    m_data = nullptr;
+    m_size = 0;
+    if (m_file.isOpen()) m_file.close();
+    m_chunks.clear();
+    m_eventBlocks.clear();
+    m_ids.clear();
+    m_names.clear();
+    // Chunk numbers refer to the closed file
+    m_cachedChunk = m_nextCachedChunk = -1;
+    m_cache = RecordingChunk();
+    m_nextCache = RecordingChunk();
+}
+
+QByteArray RecordingReader::scenario() const {
+    if (!m_data) return QByteArray();
+    return QByteArray(reinterpret_cast<const char*>(m_data) + sizeof(FileHeader), static_cast<int>(m_header.scenarioSize));
+}
+
+double RecordingReader::startTime() const {
+    return m_chunks.empty() ? 0.0 : m_chunks.front().firstTime;
+}
+
+double RecordingReader::endTime() const {
+    return m_chunks.empty() ? 0.0 : m_chunks.back().lastTime;
+}
+
+// The trailer points at the index block written by RecordingWriter::close
+bool RecordingReader::readIndex() {
+    if (m_size < sizeof(FileHeader) + sizeof(Trailer)) return false;
+    Trailer trailer;
+    std::memcpy(&trailer, m_data + m_size - sizeof(Trailer), sizeof(trailer));
+    if (std::memcmp(trailer.magic, IndexMagic, sizeof(IndexMagic)) != 0 ||
+        trailer.indexOffset + sizeof(BlockHeader) > m_size - sizeof(Trailer)) return false;
+
+    BlockHeader header;
+    std::memcpy(&header, m_data + trailer.indexOffset, sizeof(header));
+    if (header.type != IndexBlock) return false;
+    Cursor cursor{reinterpret_cast<const char*>(m_data) + trailer.indexOffset + sizeof(BlockHeader),
+                  m_size - sizeof(Trailer) - trailer.indexOffset - sizeof(BlockHeader)};
+    quint32 count = 0;
+    std::vector<IndexEntry> entries;
+    if (!cursor.read(count) || !cursor.readColumn(entries, count)) return false;
+
+    // Checked without overflow: offset and size come from the file
+    for (const IndexEntry& entry : entries) {
+        if (entry.size < sizeof(BlockHeader) || entry.offset > trailer.indexOffset ||
+            entry.size > trailer.indexOffset - entry.offset) return false;
+        addEntry(entry);
+    }
+    return true;
+}
+
+// Rebuilds the index from the blocks themselves; a torn last block is dropped
+bool RecordingReader::scanBlocks() {
+    m_chunks.clear();
+    m_eventBlocks.clear();
+    quint64 offset = sizeof(FileHeader) + m_header.scenarioSize;
+    double lastTime = 0;
+    while (offset + sizeof(BlockHeader) <= m_size) {
+        BlockHeader header;
+        std::memcpy(&header, m_data + offset, sizeof(header));
+        if (header.payloadSize > m_size - offset - sizeof(BlockHeader)) break;
+
+        IndexEntry entry = {};
+        entry.type = header.type;
+        entry.offset = offset;
+        entry.size = sizeof(BlockHeader) + header.payloadSize;
+        entry.firstTime = entry.lastTime = lastTime;
+        if (header.type == FrameBlock) {
+            ChunkHeader chunk;
+            const QByteArray body = chunkBody(entry, chunk);
+            if (body.isEmpty() || chunk.tickCount == 0) break;
+            const size_t timesAt = chunk.entityCount * sizeof(quint32);
+            if (timesAt + chunk.tickCount * sizeof(double) > static_cast<size_t>(body.size())) break;
+            std::memcpy(&entry.firstTime, body.constData() + timesAt, sizeof(double));
+            std::memcpy(&entry.lastTime, body.constData() + timesAt + (chunk.tickCount - 1) * sizeof(double), sizeof(double));
+            entry.firstTick = chunk.firstTick;
+            entry.tickCount = chunk.tickCount;
+            lastTime = entry.lastTime;
+
+            // The bounds live in the index that was never written
+            RecordingChunk decodedChunk;
+            if (!decodeEntry(entry, decodedChunk)) break;
+            float boundsMin[3], boundsMax[3];
+            clearBounds(boundsMin, boundsMax);
+            for (size_t i = 0; i < decodedChunk.positions.size(); i += 3) {
+                extendBounds(boundsMin, boundsMax, &decodedChunk.positions[i]);
+            }
+            std::memcpy(entry.boundsMin, boundsMin, sizeof(boundsMin));
+            std::memcpy(entry.boundsMax, boundsMax, sizeof(boundsMax));
+        } else if (header.type == IndexBlock) {
+            break;
+        }
+        addEntry(entry);
+        offset += entry.size;
+    }
+    if (m_chunks.empty()) {
+        Console::error("RecordingReader: no complete frame block in " + m_file.fileName().toStdString());
+        return false;
+    }
+    return true;
+}
+
+void RecordingReader::addEntry(const IndexEntry& entry) {
+    if (entry.type == FrameBlock && entry.tickCount > 0) m_chunks.push_back(entry);
+    else if (entry.type == EventBlock) m_eventBlocks.push_back(entry);
+    else if (entry.type == EntityBlock) readEntities(entry);
+}
+
+bool RecordingReader::readEntities(const IndexEntry& entry) {
+    Cursor cursor{reinterpret_cast<const char*>(m_data) + entry.offset + sizeof(BlockHeader),
+                  entry.size - sizeof(BlockHeader)};
+    quint32 count = 0;
+    if (!cursor.read(count)) return false;
+    for (quint32 i = 0; i < count; ++i) {
+        quint32 slot = 0;
+        std::string id, name;
+        if (!cursor.read(slot) || !cursor.readString(id) || !cursor.readString(name)) return false;
+        if (slot >= m_ids.size()) {
+            m_ids.resize(slot + 1);
+            m_names.resize(slot + 1);
+        }
+        m_ids[slot] = id;
+        m_names[slot] = name;
+    }
+    return true;
+}
+
+QByteArray RecordingReader::chunkBody(const IndexEntry& entry, ChunkHeader& chunk) const {
+    if (entry.size < sizeof(BlockHeader) || entry.offset > m_size || entry.size > m_size - entry.offset) return QByteArray();
+    const char* payload = reinterpret_cast<const char*>(m_data) + entry.offset + sizeof(BlockHeader);
+    const quint64 payloadSize = entry.size - sizeof(BlockHeader);
+    if (payloadSize < sizeof(ChunkHeader)) return QByteArray();
+    std::memcpy(&chunk, payload, sizeof(chunk));
+
+    const char* body = payload + sizeof(ChunkHeader);
+    const int bodySize = static_cast<int>(payloadSize - sizeof(ChunkHeader));
+    QByteArray out = (chunk.flags & Compressed) ? qUncompress(reinterpret_cast<const uchar*>(body), bodySize)
+                                                : QByteArray(body, bodySize);
+    if (static_cast<quint32>(out.size()) != chunk.bodySize) return QByteArray();
+    return out;
+}
+
+int RecordingReader::findChunk(double time) const {
+    if (m_chunks.empty()) return -1;
+    auto it = std::upper_bound(m_chunks.begin(), m_chunks.end(), time, [](double t, const IndexEntry& entry) {
+        return t < entry.firstTime;
+    });
+    return it == m_chunks.begin() ? 0 : static_cast<int>(it - m_chunks.begin()) - 1;
+}
+
+void RecordingReader::chunkRange(double from, double to, int& first, int& last) const {
+    first = findChunk(from);
+    last = first;
+    if (first < 0) {
+        first = last = 0;
+        return;
+    }
+    if (m_chunks[first].lastTime < from) first++;
+    while (last < chunkCount() && m_chunks[last].firstTime <= to) last++;
+    if (last < first) last = first;
+}
+
+bool RecordingReader::decodeChunk(int chunkIndex, RecordingChunk& out) const {
+    if (chunkIndex < 0 || chunkIndex >= chunkCount()) return false;
+    return decodeEntry(m_chunks[chunkIndex], out);
+}
+
+// Starts from the keyframe and applies each tick's deltas in order
+bool RecordingReader::decodeEntry(const IndexEntry& entry, RecordingChunk& out) const {
+    ChunkHeader chunk;
+    const QByteArray body = chunkBody(entry, chunk);
+    if (body.isEmpty() || chunk.tickCount == 0) return false;
+
+    const size_t n = chunk.entityCount, ticks = chunk.tickCount;
+    Cursor cursor{body.constData(), static_cast<size_t>(body.size())};
+    out.firstTick = chunk.firstTick;
+    out.hasHash = chunk.flags & HasStateHash;
+    out.positions.resize(ticks * n * 3);
+    out.orientations.resize(ticks * n * 4);
+    out.velocities.resize(ticks * n * 3);
+    if (!cursor.readColumn(out.slots, n) || !cursor.readColumn(out.times, ticks)) return false;
+    if (out.hasHash && !cursor.readColumn(out.hashes, ticks)) return false;
+    if (!cursor.read(out.positions.data(), n * 3 * sizeof(float)) ||
+        !cursor.read(out.orientations.data(), n * 4 * sizeof(float)) ||
+        !cursor.read(out.velocities.data(), n * 3 * sizeof(float))) return false;
+
+    qint32 steps[4];
+    for (size_t t = 1; t < ticks; ++t) {
+        float* position = &out.positions[t * n * 3];
+        float* orientation = &out.orientations[t * n * 4];
+        float* velocity = &out.velocities[t * n * 3];
+        std::copy(position - n * 3, position, position);
+        std::copy(orientation - n * 4, orientation, orientation);
+        std::copy(velocity - n * 3, velocity, velocity);
+
+        quint32 changed = 0;
+        if (!cursor.read(changed)) return false;
+        for (quint32 c = 0; c < changed; ++c) {
+            quint32 row = 0;
+            quint8 mask = 0;
+            if (!cursor.read(row) || !cursor.read(mask) || row >= n) return false;
+            if (mask & PositionDelta) {
+                if (!cursor.read(steps, 3 * sizeof(qint32))) return false;
+                for (int k = 0; k < 3; ++k) position[row * 3 + k] = applyDelta(position[row * 3 + k], steps[k], m_header.positionStep);
+            }
+            if (mask & OrientationDelta) {
+                if (!cursor.read(steps, 4 * sizeof(qint32))) return false;
+                for (int k = 0; k < 4; ++k) orientation[row * 4 + k] = applyDelta(orientation[row * 4 + k], steps[k], m_header.orientationStep);
+            }
+            if (mask & VelocityDelta) {
+                if (!cursor.read(steps, 3 * sizeof(qint32))) return false;
+                for (int k = 0; k < 3; ++k) velocity[row * 3 + k] = applyDelta(velocity[row * 3 + k], steps[k], m_header.velocityStep);
+            }
+        }
+    }
+    return true;
+}
+
+// Two decoded chunks are kept so playback across a chunk boundary swaps
+// instead of decoding again
+const RecordingChunk* RecordingReader::decoded(int chunk) {
+    if (chunk == m_cachedChunk) return &m_cache;
+    if (chunk == m_nextCachedChunk) {
+        std::swap(m_cache, m_nextCache);
+        std::swap(m_cachedChunk, m_nextCachedChunk);
+        return &m_cache;
+    }
+    std::swap(m_cache, m_nextCache);
+    m_nextCachedChunk = m_cachedChunk;
+    m_cachedChunk = -1;
+    if (!decodeChunk(chunk, m_cache)) {
+        Console::error("RecordingReader: chunk " + std::to_string(chunk) + " is corrupt");
+        return nullptr;
+    }
+    m_cachedChunk = chunk;
+    return &m_cache;
+}
+
+const RecordingChunk* RecordingReader::chunkAt(double time, int* tickIndex) {
+    const int chunk = findChunk(time);
+    if (chunk < 0) return nullptr;
+    const RecordingChunk* decodedChunk = decoded(chunk);
+    if (decodedChunk && tickIndex) {
+        auto it = std::upper_bound(decodedChunk->times.begin(), decodedChunk->times.end(), time);
+        *tickIndex = it == decodedChunk->times.begin() ? 0 : static_cast<int>(it - decodedChunk->times.begin()) - 1;
+    }
+    return decodedChunk;
+}
+
+bool RecordingReader::frameAt(double time, RecordingFrame& out) {
+    int tick = 0;
+    const RecordingChunk* chunk = chunkAt(time, &tick);
+    if (!chunk) return false;
+    chunk->frame(tick, out);
+    return true;
+}
+
+bool RecordingReader::sampleAt(double time, RecordingFrame& out) {
+    int tick = 0;
+    const int chunkIndex = findChunk(time);
+    const RecordingChunk* chunk = chunkAt(time, &tick);
+    if (!chunk) return false;
+    chunk->frame(tick, out);
+    if (time <= out.time) return true;
+
+    // The following sample is in this chunk or opens the next one
+    if (tick + 1 < chunk->tickCount()) {
+        chunk->frame(tick + 1, m_after);
+    } else if (chunkIndex + 1 < chunkCount()) {
+        const int current = m_cachedChunk;
+        const RecordingChunk* next = decoded(chunkIndex + 1);
+        if (!next) return true;
+        next->frame(0, m_after);
+        decoded(current); // swaps back; both stay cached
+    } else {
+        return true; // past the last sample
+    }
+
+    const double span = m_after.time - out.time;
+    if (span <= 0) return true;
+    const float alpha = static_cast<float>((time - out.time) / span);
+    const bool sameSlots = out.slots == m_after.slots;
+    for (size_t i = 0; i < out.slots.size(); ++i) {
+        size_t j = i;
+        if (!sameSlots) {
+            auto it = std::find(m_after.slots.begin(), m_after.slots.end(), out.slots[i]);
+            if (it == m_after.slots.end()) continue;
+            j = it - m_after.slots.begin();
+        }
+        out.positions[i] += (m_after.positions[j] - out.positions[i]) * alpha;
+        out.velocities[i] += (m_after.velocities[j] - out.velocities[i]) * alpha;
+        out.orientations[i] = QQuaternion::slerp(out.orientations[i], m_after.orientations[j], alpha);
+    }
+    out.time = time;
+    return true;
+}
+
+int RecordingReader::findSlot(const std::string& id) const {
+    auto it = std::find(m_ids.begin(), m_ids.end(), id);
+    return it == m_ids.end() ? -1 : static_cast<int>(it - m_ids.begin());
+}
+
+QJsonArray RecordingReader::events(double from, double to) const {
+    QJsonArray out;
+    for (const IndexEntry& entry : m_eventBlocks) {
+        const QByteArray json(reinterpret_cast<const char*>(m_data) + entry.offset + sizeof(BlockHeader),
+                              static_cast<int>(entry.size - sizeof(BlockHeader)));
+        for (const QJsonValue& value : QJsonDocument::fromJson(json).array()) {
+            const double time = value.toObject()["time"].toDouble();
+            if (time >= from && time <= to) out.append(value);
+        }
+    }
+    return out;
+}
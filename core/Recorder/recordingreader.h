@@ -0,0 +1,105 @@
+#ifndef RECORDINGREADER_H
+#define RECORDINGREADER_H
+
+#include <core/Recorder/recordingformat.h>
+#include <QByteArray>
+#include <QFile>
+#include <QJsonArray>
+#include <QQuaternion>
+#include <QString>
+#include <QVector3D>
+#include <string>
+#include <vector>
+
+// State of every recorded entity at one tick
+struct RecordingFrame {
+    qint64 tick = 0;
+    double time = 0;
+    quint64 stateHash = 0;
+    std::vector<quint32> slots;
+    std::vector<QVector3D> positions;
+    std::vector<QQuaternion> orientations;
+    std::vector<QVector3D> velocities;
+};
+
+// One frame block decoded to full columns, [tick][entity][component]
+struct RecordingChunk {
+    qint64 firstTick = 0;
+    bool hasHash = false;
+    std::vector<quint32> slots;
+    std::vector<double> times;
+    std::vector<quint64> hashes;
+    std::vector<float> positions, orientations, velocities;
+
+    int tickCount() const { return static_cast<int>(times.size()); }
+    int entityCount() const { return static_cast<int>(slots.size()); }
+    void frame(int tick, RecordingFrame& out) const;
+};
+
+// Random access to a binary recording. The file is memory mapped and only
+// the chunk index and entity table are parsed up front; a seek is a binary
+// search over chunk start times plus one chunk decode from its keyframe.
+// Files cut short by a crash have no index and are scanned block by block.
+class RecordingReader
+{
+public:
+    ~RecordingReader();
+
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return m_data != nullptr; }
+    QString path() const { return m_file.fileName(); }
+
+    double timeStep() const { return m_header.timeStep; }
+    QByteArray scenario() const;
+    double startTime() const;
+    double endTime() const;
+    double duration() const { return endTime() - startTime(); }
+
+    int chunkCount() const { return static_cast<int>(m_chunks.size()); }
+    const RecordingFormat::IndexEntry& chunkEntry(int chunk) const { return m_chunks[chunk]; }
+    int findChunk(double time) const; // chunk holding time, clamped to the recording
+    // Chunks with samples inside [from, to], as a range [first, last)
+    void chunkRange(double from, double to, int& first, int& last) const;
+    bool decodeChunk(int chunk, RecordingChunk& out) const; // no shared state, safe from any thread
+
+    // Last sample at or before time; consecutive seeks inside one chunk reuse its decode
+    bool frameAt(double time, RecordingFrame& out);
+    const RecordingChunk* chunkAt(double time, int* tickIndex = nullptr);
+
+    // State at any time between samples: positions and velocities are
+    // interpolated linearly, orientations slerped. Costs one binary search
+    // and at most two chunk decodes however far the time jumped.
+    bool sampleAt(double time, RecordingFrame& out);
+
+    int entityCount() const { return static_cast<int>(m_ids.size()); }
+    std::string entityId(quint32 slot) const { return slot < m_ids.size() ? m_ids[slot] : std::string(); }
+    std::string entityName(quint32 slot) const { return slot < m_names.size() ? m_names[slot] : std::string(); }
+    int findSlot(const std::string& id) const; // -1 when not recorded
+
+    QJsonArray events(double from, double to) const; // track events stamped inside [from, to]
+
+private:
+    bool readIndex();
+    bool scanBlocks();
+    void addEntry(const RecordingFormat::IndexEntry& entry);
+    bool readEntities(const RecordingFormat::IndexEntry& entry);
+    QByteArray chunkBody(const RecordingFormat::IndexEntry& entry, RecordingFormat::ChunkHeader& chunk) const;
+    bool decodeEntry(const RecordingFormat::IndexEntry& entry, RecordingChunk& out) const;
+
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    quint64 m_size = 0;
+    RecordingFormat::FileHeader m_header = {};
+    std::vector<RecordingFormat::IndexEntry> m_chunks; // frame blocks in time order
+    std::vector<RecordingFormat::IndexEntry> m_eventBlocks;
+    std::vector<std::string> m_ids, m_names; // by slot
+
+    const RecordingChunk* decoded(int chunk);
+
+    RecordingChunk m_cache, m_nextCache; // current chunk and the one after it
+    int m_cachedChunk = -1, m_nextCachedChunk = -1;
+    RecordingFrame m_after; // sample following the one sampleAt starts from
+};
+
+#endif // RECORDINGREADER_H
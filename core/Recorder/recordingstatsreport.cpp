@@ -0,0 +1,64 @@
+#include "recordingstatsreport.h"
+#include "core/Recorder/recorder.h"
+#include "core/Simulation/batchrunner.h"
+#include <core/Debug/console.h>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+bool RecordingStatsReport::run(const QStringList& scenarios, const BatchOptions& options) {
+    if (scenarios.isEmpty()) {
+        Console::error("RecordingStatsReport: --recording-stats needs at least one scenario");
+        return false;
+    }
+    QTemporaryDir directory;
+    if (!directory.isValid()) {
+        Console::error("RecordingStatsReport: no temporary directory for recordings");
+        return false;
+    }
+
+    bool ok = true;
+    for (const QString& scenario : scenarios) {
+        BatchRunner runner;
+        BatchOptions scenarioOptions = options;
+        scenarioOptions.scenarioPath = scenario;
+        scenarioOptions.outputPath = directory.filePath(QFileInfo(scenario).completeBaseName() + ".tdfr");
+        if (!runner.loadScenario(scenario) || !runner.run(scenarioOptions)) {
+            ok = false;
+            continue;
+        }
+
+        const RecordingStats& stats = runner.recorder->recordingStats();
+        const double deltaShare = stats.rows ? 100.0 * stats.deltaRows / stats.rows : 0.0;
+        Console::log("Recording stats " + QFileInfo(scenario).fileName().toStdString() + ": " +
+                     std::to_string(stats.ticks) + " ticks, " + std::to_string(stats.rows) + " samples (" +
+                     std::to_string(deltaShare) + "% deltas, " +
+                     std::to_string(stats.rows - stats.deltaRows - stats.keyframeRows) + " unchanged)");
+        Console::log("  raw " + std::to_string(stats.rawBytes) + " B, delta " + std::to_string(stats.encodedBytes) +
+                     " B, compressed " + std::to_string(stats.storedBytes) + " B, ratio " + std::to_string(stats.ratio()) + "x");
+        Console::log("  replay error: position max " + std::to_string(stats.maxPositionError) + " m, rms " +
+                     std::to_string(stats.rmsPositionError()) + " m; orientation max " +
+                     std::to_string(stats.maxOrientationError) + "; velocity max " +
+                     std::to_string(stats.maxVelocityError) + " m/s");
+    }
+    return ok;
+}
+
+int RecordingStatsReport::exec(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("TDF recording compression report");
+    parser.addHelpOption();
+    QCommandLineOption statsOption("recording-stats", "Record each scenario given as an argument and report compression ratio and replay error.");
+    QCommandLineOption durationOption("duration", "Simulated seconds to record (default 60).", "seconds", "60");
+    QCommandLineOption stepOption("dt", "Fixed time step in seconds (default 1/60).", "seconds");
+    QCommandLineOption intervalOption("record-interval", "Simulated seconds between recorded ticks, rounded to whole steps (default 0.1).", "seconds", "0.1");
+    parser.addOptions({statsOption, durationOption, stepOption, intervalOption});
+    parser.addPositionalArgument("scenarios", "Scenario JSON files to record.", "[scenarios...]");
+    parser.process(arguments);
+
+    BatchOptions options;
+    options.duration = parser.value(durationOption).toDouble();
+    options.timeStep = parser.isSet(stepOption) ? parser.value(stepOption).toDouble() : 1.0 / 60;
+    options.recordInterval = parser.value(intervalOption).toDouble();
+    return run(parser.positionalArguments(), options) ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+#ifndef RECORDINGSTATSREPORT_H
+#define RECORDINGSTATSREPORT_H
+
+#include <QStringList>
+
+struct BatchOptions;
+
+// Records each scenario headless into a temporary directory and reports the
+// keyframe/delta compression ratio and the largest error replay would
+// reconstruct; "--recording-stats a.json b.json" on the headless entry point.
+class RecordingStatsReport
+{
+public:
+    static bool run(const QStringList& scenarios, const BatchOptions& options);
+    static int exec(const QStringList& arguments);
+};
+
+#endif // RECORDINGSTATSREPORT_H
@@ -0,0 +1,176 @@
+#include "recordingstream.h"
+#include <core/Debug/console.h>
+#include <chrono>
+
+using Clock = std::chrono::steady_clock;
+
+static const int IdleWaitMs = 50; // writer wake-up when nothing is queued
+
+RecordingStream::RecordingStream(size_t queueCapacity)
+    : m_queue(queueCapacity) {}
+
+RecordingStream::~RecordingStream() {
+    close();
+}
+
+// The header is written here so a bad path fails the call itself; from then
+// on the file belongs to the writer thread until close()
+bool RecordingStream::open(const QString& path, const QByteArray& scenarioJson, double timeStep,
+                           const RecordingEncoding& encoding, int syncIntervalMs) {
+    close();
+    if (!m_writer.open(path, scenarioJson, timeStep, encoding)) return false;
+
+    m_path = path;
+    m_syncIntervalMs = syncIntervalMs;
+    m_commands = 0;
+    m_highWater = 0;
+    m_stalls = 0;
+    m_stallNs = 0;
+    m_bytes = m_writer.bytesWritten();
+    m_syncs = 0;
+    m_stopping = false;
+    m_open = true;
+    m_thread = std::thread(&RecordingStream::run, this);
+    return true;
+}
+
+void RecordingStream::close() {
+    if (!m_open) return;
+    if (m_building) endTick();
+    m_stopping.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_wake.notify_one();
+    }
+    m_thread.join();
+    m_writer.close();
+    m_bytes = m_writer.bytesWritten();
+    m_open = false;
+}
+
+void RecordingStream::defineEntity(quint32 slot, const std::string& id, const std::string& name) {
+    Command* command = acquire();
+    command->type = Command::Define;
+    command->slot = slot;
+    command->id = id;
+    command->name = name;
+    publish();
+}
+
+void RecordingStream::beginTick(qint64 tick, double time, quint64 stateHash, bool hasHash) {
+    m_building = acquire();
+    m_building->type = Command::Tick;
+    m_building->tick = tick;
+    m_building->time = time;
+    m_building->hash = stateHash;
+    m_building->hasHash = hasHash;
+    m_building->slots.clear();
+    m_building->values.clear();
+}
+
+void RecordingStream::addRow(quint32 slot, const QVector3D& position, const QQuaternion& orientation, const QVector3D& velocity) {
+    m_building->slots.push_back(slot);
+    m_building->values.insert(m_building->values.end(), {
+        position.x(), position.y(), position.z(),
+        orientation.scalar(), orientation.x(), orientation.y(), orientation.z(),
+        velocity.x(), velocity.y(), velocity.z()});
+}
+
+void RecordingStream::endTick() {
+    m_building = nullptr;
+    publish();
+}
+
+void RecordingStream::writeEvents(const QByteArray& jsonArray) {
+    Command* command = acquire();
+    command->type = Command::Events;
+    command->data = jsonArray;
+    publish();
+}
+
+RecordingStreamStats RecordingStream::streamStats() const {
+    RecordingStreamStats stats;
+    stats.commands = m_commands;
+    stats.depth = m_queue.size();
+    stats.highWater = m_highWater;
+    stats.capacity = m_queue.capacity();
+    stats.stalls = m_stalls;
+    stats.stallSeconds = m_stallNs / 1e9;
+    stats.bytesWritten = m_bytes;
+    stats.syncs = m_syncs;
+    return stats;
+}
+
+// Waits for a free entry when the writer has fallen a full ring behind
+RecordingStream::Command* RecordingStream::acquire() {
+    Command* command = m_queue.acquire();
+    if (command) return command;
+
+    m_stalls++;
+    const Clock::time_point start = Clock::now();
+    while (!(command = m_queue.acquire())) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    m_stallNs += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    return command;
+}
+
+void RecordingStream::publish() {
+    m_queue.publish();
+    m_commands++;
+    const size_t depth = m_queue.size();
+    if (depth > m_highWater.load(std::memory_order_relaxed)) m_highWater.store(depth, std::memory_order_relaxed);
+
+    // Pairs with the fence in run() so a publish never slips past a writer going to sleep
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_wake.notify_one();
+    }
+}
+
+void RecordingStream::run() {
+    Clock::time_point lastSync = Clock::now();
+    while (true) {
+        if (Command* command = m_queue.front()) {
+            apply(*command);
+            m_queue.pop();
+            m_bytes.store(m_writer.bytesWritten(), std::memory_order_relaxed);
+        } else if (m_stopping.load(std::memory_order_acquire)) {
+            if (!m_queue.front()) break;
+        } else {
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            m_wake.wait_for(lock, std::chrono::milliseconds(IdleWaitMs), [this] {
+                return m_queue.front() != nullptr || m_stopping.load(std::memory_order_acquire);
+            });
+            m_sleeping.store(false, std::memory_order_relaxed);
+        }
+
+        if (m_syncIntervalMs > 0 && Clock::now() - lastSync >= std::chrono::milliseconds(m_syncIntervalMs)) {
+            if (m_writer.sync()) m_syncs++;
+            lastSync = Clock::now();
+        }
+    }
+}
+
+void RecordingStream::apply(const Command& command) {
+    switch (command.type) {
+    case Command::Define:
+        m_writer.defineEntity(command.slot, command.id, command.name);
+        break;
+    case Command::Events:
+        m_writer.writeEvents(command.data);
+        break;
+    case Command::Tick:
+        m_writer.beginTick(command.tick, command.time, command.hash, command.hasHash);
+        for (size_t i = 0; i < command.slots.size(); ++i) {
+            const float* v = &command.values[i * 10];
+            m_writer.addRow(command.slots[i], QVector3D(v[0], v[1], v[2]),
+                            QQuaternion(v[3], v[4], v[5], v[6]), QVector3D(v[7], v[8], v[9]));
+        }
+        m_writer.endTick();
+        break;
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef RECORDINGSTREAM_H
+#define RECORDINGSTREAM_H
+
+#include <core/Recorder/recordingwriter.h>
+#include <core/Recorder/spscqueue.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Backpressure between the simulation and the writer thread
+struct RecordingStreamStats {
+    quint64 commands = 0;     // ticks, definitions and event blocks queued
+    size_t depth = 0;         // entries waiting right now
+    size_t highWater = 0;     // deepest the queue has been
+    size_t capacity = 0;
+    quint64 stalls = 0;       // pushes that found the queue full
+    double stallSeconds = 0;  // producer time spent waiting for space
+    quint64 bytesWritten = 0;
+    quint64 syncs = 0;        // fsyncs issued
+};
+
+// Front end of RecordingWriter for the simulation thread. Calls are queued
+// through a bounded lock-free ring to a dedicated thread that encodes,
+// compresses and writes the chunks and fsyncs the file periodically, so a
+// crash loses at most the last sync interval and memory stays flat. When
+// the ring is full the producer waits rather than dropping ticks.
+class RecordingStream
+{
+public:
+    explicit RecordingStream(size_t queueCapacity = 1024);
+    ~RecordingStream();
+
+    bool open(const QString& path, const QByteArray& scenarioJson, double timeStep,
+              const RecordingEncoding& encoding = RecordingEncoding(), int syncIntervalMs = 1000);
+    void close(); // drains the queue, writes the index and joins the thread
+    bool isOpen() const { return m_open; }
+    QString path() const { return m_path; }
+
+    // Same sequence as RecordingWriter; only called from one thread
+    void defineEntity(quint32 slot, const std::string& id, const std::string& name);
+    void beginTick(qint64 tick, double time, quint64 stateHash = 0, bool hasHash = false);
+    void addRow(quint32 slot, const QVector3D& position, const QQuaternion& orientation, const QVector3D& velocity);
+    void endTick();
+    void writeEvents(const QByteArray& jsonArray);
+
+    RecordingStreamStats streamStats() const;
+    const RecordingStats& stats() const { return m_writer.stats(); } // complete once closed
+
+private:
+    struct Command {
+        enum Type { Define, Tick, Events } type = Tick;
+        qint64 tick = 0;
+        double time = 0;
+        quint64 hash = 0;
+        bool hasHash = false;
+        std::vector<quint32> slots;
+        std::vector<float> values; // per row: position 3, orientation 4, velocity 3
+        quint32 slot = 0;
+        std::string id, name;
+        QByteArray data;
+    };
+
+    Command* acquire();
+    void publish();
+    void run();
+    void apply(const Command& command);
+
+    RecordingWriter m_writer; // owned by the writer thread while open
+    SpscQueue<Command> m_queue;
+    Command* m_building = nullptr; // tick between beginTick and endTick
+    std::thread m_thread;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_sleeping{false};
+    std::atomic<bool> m_stopping{false};
+    bool m_open = false;
+    QString m_path;
+    int m_syncIntervalMs = 1000;
+
+    std::atomic<quint64> m_commands{0};
+    std::atomic<size_t> m_highWater{0};
+    std::atomic<quint64> m_stalls{0};
+    std::atomic<qint64> m_stallNs{0};
+    std::atomic<quint64> m_bytes{0};
+    std::atomic<quint64> m_syncs{0};
+};
+
+#endif // RECORDINGSTREAM_H
@@ -0,0 +1,313 @@
+#include "recordingwriter.h"
+#include <core/Debug/console.h>
+#include <algorithm>
+#include <cstring>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace RecordingFormat;
+
+template <typename T>
+static void appendRaw(QByteArray& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+static void appendColumn(QByteArray& out, const std::vector<T>& column) {
+    out.append(reinterpret_cast<const char*>(column.data()), static_cast<int>(column.size() * sizeof(T)));
+}
+
+// Quantises actual - decoded into whole steps and advances decoded by them.
+// Returns false, leaving decoded alone, when every component is within half
+// a step.
+static bool quantise(const float* actual, float* decoded, int count, float step, qint32* steps) {
+    const double limit = 1 << 30;
+    bool changed = false;
+    for (int c = 0; c < count; ++c) {
+        const double q = std::round((double(actual[c]) - decoded[c]) / step);
+        steps[c] = static_cast<qint32>(std::max(-limit, std::min(limit, q)));
+        changed |= steps[c] != 0;
+    }
+    if (changed) {
+        for (int c = 0; c < count; ++c) decoded[c] = applyDelta(decoded[c], steps[c], step);
+    }
+    return changed;
+}
+
+static void appendString(QByteArray& out, const std::string& s) {
+    const quint16 length = static_cast<quint16>(std::min<size_t>(s.size(), 0xFFFF));
+    appendRaw(out, length);
+    out.append(s.data(), length);
+}
+
+RecordingWriter::~RecordingWriter() {
+    close();
+}
+
+bool RecordingWriter::open(const QString& path, const QByteArray& scenarioJson, double timeStep,
+                           const RecordingEncoding& encoding) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        Console::error("RecordingWriter: failed to open " + path.toStdString());
+        return false;
+    }
+
+    m_bytes = 0;
+    m_encoding = encoding;
+    m_stats = RecordingStats();
+    m_index.clear();
+    m_entityDefs.clear();
+    m_entityCount = 0;
+    m_slots.clear();
+    m_times.clear();
+
+    FileHeader header;
+    std::memcpy(header.magic, Magic, sizeof(header.magic));
+    header.version = Version;
+    header.timeStep = timeStep;
+    header.scenarioSize = static_cast<quint64>(scenarioJson.size());
+    header.positionStep = encoding.positionStep;
+    header.orientationStep = encoding.orientationStep;
+    header.velocityStep = encoding.velocityStep;
+    header.reserved = 0;
+    m_bytes += m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_bytes += m_file.write(scenarioJson);
+    return true;
+}
+
+bool RecordingWriter::close() {
+    if (!m_file.isOpen()) return false;
+    flushEntities();
+    flushChunk();
+
+    const quint64 indexOffset = m_bytes;
+    QByteArray payload;
+    appendRaw(payload, static_cast<quint32>(m_index.size()));
+    appendColumn(payload, m_index);
+    BlockHeader header{IndexBlock, 0, static_cast<quint64>(payload.size())};
+    m_bytes += m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_bytes += m_file.write(payload);
+
+    Trailer trailer;
+    trailer.indexOffset = indexOffset;
+    std::memcpy(trailer.magic, IndexMagic, sizeof(trailer.magic));
+    trailer.version = Version;
+    m_bytes += m_file.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+
+    m_file.close();
+    return true;
+}
+
+bool RecordingWriter::sync() {
+    if (!m_file.isOpen() || !m_file.flush()) return false;
+#ifdef Q_OS_WIN
+    return _commit(m_file.handle()) == 0;
+#else
+    return fsync(m_file.handle()) == 0;
+#endif
+}
+
+void RecordingWriter::defineEntity(quint32 slot, const std::string& id, const std::string& name) {
+    appendRaw(m_entityDefs, slot);
+    appendString(m_entityDefs, id);
+    appendString(m_entityDefs, name);
+    m_entityCount++;
+}
+
+void RecordingWriter::beginTick(qint64 tick, double time, quint64 stateHash, bool hasHash) {
+    m_tick = tick;
+    m_time = time;
+    m_hash = stateHash;
+    m_hasHash = hasHash;
+    m_rowSlots.clear();
+    m_rowPositions.clear();
+    m_rowOrientations.clear();
+    m_rowVelocities.clear();
+}
+
+void RecordingWriter::addRow(quint32 slot, const QVector3D& position, const QQuaternion& orientation, const QVector3D& velocity) {
+    m_rowSlots.push_back(slot);
+    m_rowPositions.insert(m_rowPositions.end(), {position.x(), position.y(), position.z()});
+    m_rowOrientations.insert(m_rowOrientations.end(), {orientation.scalar(), orientation.x(), orientation.y(), orientation.z()});
+    m_rowVelocities.insert(m_rowVelocities.end(), {velocity.x(), velocity.y(), velocity.z()});
+}
+
+void RecordingWriter::endTick() {
+    if (!m_file.isOpen()) return;
+
+    // A chunk has one slot column, so a changed entity set starts a new one
+    if (!m_times.empty() && (m_rowSlots != m_slots || m_hasHash != m_chunkHasHash ||
+                             static_cast<int>(m_times.size()) >= ChunkTicks)) {
+        flushChunk();
+    }
+    if (m_times.empty()) {
+        m_slots = m_rowSlots;
+        m_firstTick = m_tick;
+        m_chunkHasHash = m_hasHash;
+    }
+
+    m_times.push_back(m_time);
+    if (m_chunkHasHash) m_hashes.push_back(m_hash);
+    m_positions.insert(m_positions.end(), m_rowPositions.begin(), m_rowPositions.end());
+    m_orientations.insert(m_orientations.end(), m_rowOrientations.begin(), m_rowOrientations.end());
+    m_velocities.insert(m_velocities.end(), m_rowVelocities.begin(), m_rowVelocities.end());
+}
+
+void RecordingWriter::writeEvents(const QByteArray& jsonArray) {
+    if (!m_file.isOpen() || jsonArray.isEmpty()) return;
+    writeBlock(EventBlock, jsonArray, m_tick, 0, m_time, m_time);
+}
+
+// Definitions always land before the first chunk that uses their slots
+void RecordingWriter::flushEntities() {
+    if (m_entityCount == 0) return;
+    QByteArray payload;
+    appendRaw(payload, m_entityCount);
+    payload.append(m_entityDefs);
+    writeBlock(EntityBlock, payload);
+    m_entityDefs.clear();
+    m_entityCount = 0;
+}
+
+void RecordingWriter::flushChunk() {
+    flushEntities();
+    if (m_times.empty()) return;
+
+    const QByteArray body = encodeChunk();
+
+    ChunkHeader chunk;
+    chunk.firstTick = m_firstTick;
+    chunk.tickCount = static_cast<quint32>(m_times.size());
+    chunk.entityCount = static_cast<quint32>(m_slots.size());
+    chunk.flags = 0;
+    if (m_chunkHasHash) chunk.flags |= HasStateHash;
+    if (m_encoding.compress) chunk.flags |= Compressed;
+    chunk.bodySize = static_cast<quint32>(body.size());
+
+    QByteArray payload;
+    appendRaw(payload, chunk);
+    payload.append(m_encoding.compress ? qCompress(body, m_encoding.compressionLevel) : body);
+    writeBlock(FrameBlock, payload, m_firstTick, chunk.tickCount, m_times.front(), m_times.back());
+    std::memcpy(m_index.back().boundsMin, m_boundsMin, sizeof(m_boundsMin));
+    std::memcpy(m_index.back().boundsMax, m_boundsMax, sizeof(m_boundsMax));
+
+    const quint64 ticks = m_times.size(), rows = ticks * m_slots.size();
+    m_stats.ticks += ticks;
+    m_stats.rawBytes += sizeof(chunk) + m_slots.size() * 4 + ticks * (m_chunkHasHash ? 16 : 8) + rows * 40;
+    m_stats.encodedBytes += sizeof(chunk) + body.size();
+    m_stats.storedBytes += payload.size();
+
+    m_times.clear();
+    m_hashes.clear();
+    m_positions.clear();
+    m_orientations.clear();
+    m_velocities.clear();
+}
+
+// Body of a frame block: the first tick in full, then per tick only the
+// entities whose quantised state moved. Deltas are taken against the
+// decoded state, not the previous sample, so rounding never drifts.
+QByteArray RecordingWriter::encodeChunk() {
+    const size_t n = m_slots.size(), ticks = m_times.size();
+
+    QByteArray body;
+    body.reserve(static_cast<int>(n * 44 + ticks * 16));
+    appendColumn(body, m_slots);
+    appendColumn(body, m_times);
+    if (m_chunkHasHash) appendColumn(body, m_hashes);
+
+    std::vector<float> positions(m_positions.begin(), m_positions.begin() + n * 3);
+    std::vector<float> orientations(m_orientations.begin(), m_orientations.begin() + n * 4);
+    std::vector<float> velocities(m_velocities.begin(), m_velocities.begin() + n * 3);
+    appendColumn(body, positions);
+    appendColumn(body, orientations);
+    appendColumn(body, velocities);
+    m_stats.rows += n;
+    m_stats.keyframeRows += n;
+    clearBounds(m_boundsMin, m_boundsMax);
+    for (size_t i = 0; i < n; ++i) extendBounds(m_boundsMin, m_boundsMax, &positions[i * 3]);
+
+    qint32 fields[10]; // position, orientation and velocity steps of one row
+    for (size_t t = 1; t < ticks; ++t) {
+        const int countAt = body.size();
+        quint32 changed = 0;
+        appendRaw(body, changed);
+
+        for (size_t i = 0; i < n; ++i) {
+            const size_t row = t * n + i;
+            float* position = &positions[i * 3];
+            float* orientation = &orientations[i * 4];
+            float* velocity = &velocities[i * 3];
+
+            // q and -q are the same rotation; follow the decoded hemisphere
+            float actualOrientation[4];
+            std::memcpy(actualOrientation, &m_orientations[row * 4], sizeof(actualOrientation));
+            float dot = 0;
+            for (int c = 0; c < 4; ++c) dot += actualOrientation[c] * orientation[c];
+            if (dot < 0) {
+                for (float& c : actualOrientation) c = -c;
+            }
+
+            quint8 mask = 0;
+            int fieldCount = 0;
+            if (quantise(&m_positions[row * 3], position, 3, m_encoding.positionStep, fields + fieldCount)) {
+                mask |= PositionDelta;
+                fieldCount += 3;
+            }
+            if (quantise(actualOrientation, orientation, 4, m_encoding.orientationStep, fields + fieldCount)) {
+                mask |= OrientationDelta;
+                fieldCount += 4;
+            }
+            if (quantise(&m_velocities[row * 3], velocity, 3, m_encoding.velocityStep, fields + fieldCount)) {
+                mask |= VelocityDelta;
+                fieldCount += 3;
+            }
+            if (mask) {
+                appendRaw(body, static_cast<quint32>(i));
+                appendRaw(body, mask);
+                body.append(reinterpret_cast<const char*>(fields), fieldCount * static_cast<int>(sizeof(qint32)));
+                changed++;
+                m_stats.deltaRows++;
+            }
+
+            // Error of the state replay will reconstruct for this sample
+            double positionError = 0, velocityError = 0;
+            for (int c = 0; c < 3; ++c) {
+                positionError += std::pow(double(m_positions[row * 3 + c]) - position[c], 2);
+                velocityError += std::pow(double(m_velocities[row * 3 + c]) - velocity[c], 2);
+            }
+            for (int c = 0; c < 4; ++c) {
+                m_stats.maxOrientationError = std::max(m_stats.maxOrientationError,
+                                                       std::abs(double(actualOrientation[c]) - orientation[c]));
+            }
+            m_stats.maxPositionError = std::max(m_stats.maxPositionError, std::sqrt(positionError));
+            m_stats.maxVelocityError = std::max(m_stats.maxVelocityError, std::sqrt(velocityError));
+            m_stats.positionErrorSquares += positionError;
+            m_stats.rows++;
+            extendBounds(m_boundsMin, m_boundsMax, position);
+        }
+        std::memcpy(body.data() + countAt, &changed, sizeof(changed));
+    }
+    return body;
+}
+
+void RecordingWriter::writeBlock(BlockType type, const QByteArray& payload,
+                                 qint64 firstTick, quint32 tickCount, double firstTime, double lastTime) {
+    IndexEntry entry = {};
+    entry.type = type;
+    entry.tickCount = tickCount;
+    entry.firstTick = firstTick;
+    entry.firstTime = firstTime;
+    entry.lastTime = lastTime;
+    entry.offset = m_bytes;
+    entry.size = sizeof(BlockHeader) + static_cast<quint64>(payload.size());
+    m_index.push_back(entry);
+
+    BlockHeader header{type, 0, static_cast<quint64>(payload.size())};
+    m_bytes += m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_bytes += m_file.write(payload);
+}
@@ -0,0 +1,102 @@
+#ifndef RECORDINGWRITER_H
+#define RECORDINGWRITER_H
+
+#include <core/Recorder/recordingformat.h>
+#include <QByteArray>
+#include <QFile>
+#include <QQuaternion>
+#include <QString>
+#include <QVector3D>
+#include <cmath>
+#include <string>
+#include <vector>
+
+struct RecordingEncoding {
+    float positionStep = RecordingFormat::PositionStep;
+    float orientationStep = RecordingFormat::OrientationStep;
+    float velocityStep = RecordingFormat::VelocityStep;
+    bool compress = true;
+    int compressionLevel = -1; // qCompress level, -1 = zlib default
+};
+
+// Frame data written so far and how far the replayed state strays from it
+struct RecordingStats {
+    qint64 ticks = 0;
+    qint64 rows = 0;          // entity samples
+    qint64 deltaRows = 0;     // samples stored as a delta
+    qint64 keyframeRows = 0;  // samples stored in full
+    quint64 rawBytes = 0;     // frame data as full float columns every tick
+    quint64 encodedBytes = 0; // after keyframe/delta encoding
+    quint64 storedBytes = 0;  // after compression
+    double maxPositionError = 0;
+    double maxOrientationError = 0;
+    double maxVelocityError = 0;
+    double positionErrorSquares = 0; // summed over rows
+
+    double ratio() const { return storedBytes ? double(rawBytes) / storedBytes : 0.0; }
+    double rmsPositionError() const { return rows ? std::sqrt(positionErrorSquares / rows) : 0.0; }
+};
+
+// Streams a binary recording (see recordingformat.h). Ticks are gathered
+// into an in-memory chunk that is encoded and written out when it is full
+// or when the set of recorded slots changes, so memory use stays bounded by
+// one chunk.
+class RecordingWriter
+{
+public:
+    ~RecordingWriter();
+
+    bool open(const QString& path, const QByteArray& scenarioJson, double timeStep,
+              const RecordingEncoding& encoding = RecordingEncoding());
+    bool close(); // flushes the open chunk and writes the index
+    bool sync();  // pushes everything written so far to the disk
+    bool isOpen() const { return m_file.isOpen(); }
+    QString path() const { return m_file.fileName(); }
+    quint64 bytesWritten() const { return m_bytes; }
+    const RecordingStats& stats() const { return m_stats; }
+
+    void defineEntity(quint32 slot, const std::string& id, const std::string& name);
+
+    // One tick: beginTick, addRow per recorded entity (same order every
+    // tick while the set is unchanged), endTick
+    void beginTick(qint64 tick, double time, quint64 stateHash = 0, bool hasHash = false);
+    void addRow(quint32 slot, const QVector3D& position, const QQuaternion& orientation, const QVector3D& velocity);
+    void endTick();
+
+    void writeEvents(const QByteArray& jsonArray);
+
+private:
+    void flushEntities();
+    void flushChunk();
+    QByteArray encodeChunk();
+    void writeBlock(RecordingFormat::BlockType type, const QByteArray& payload,
+                    qint64 firstTick = 0, quint32 tickCount = 0, double firstTime = 0, double lastTime = 0);
+
+    QFile m_file;
+    quint64 m_bytes = 0;
+    RecordingEncoding m_encoding;
+    RecordingStats m_stats;
+    std::vector<RecordingFormat::IndexEntry> m_index;
+
+    QByteArray m_entityDefs;
+    quint32 m_entityCount = 0;
+
+    // Tick being built
+    qint64 m_tick = 0;
+    double m_time = 0;
+    quint64 m_hash = 0;
+    bool m_hasHash = false;
+    std::vector<quint32> m_rowSlots;
+    std::vector<float> m_rowPositions, m_rowOrientations, m_rowVelocities;
+
+    // Open chunk
+    qint64 m_firstTick = 0;
+    bool m_chunkHasHash = false;
+    std::vector<quint32> m_slots;
+    std::vector<double> m_times;
+    std::vector<quint64> m_hashes;
+    std::vector<float> m_positions, m_orientations, m_velocities;
+    float m_boundsMin[3], m_boundsMax[3]; // of the decoded positions, filled by encodeChunk
+};
+
+#endif // RECORDINGWRITER_H
@@ -0,0 +1,52 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded single-producer/single-consumer ring. Entries are filled and read
+// in place (acquire/publish, front/pop), so buffers inside T keep their
+// capacity from lap to lap and a steady stream allocates nothing.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacity)
+        : m_entries(roundUp(capacity)), m_mask(m_entries.size() - 1) {}
+
+    size_t capacity() const { return m_entries.size(); }
+    size_t size() const {
+        return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+    }
+
+    // Producer: slot to fill, or nullptr when full; publish() makes it visible
+    T* acquire() {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == m_entries.size()) return nullptr;
+        return &m_entries[tail & m_mask];
+    }
+    void publish() { m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // Consumer: oldest entry, or nullptr when empty; pop() hands it back
+    T* front() {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire)) return nullptr;
+        return &m_entries[head & m_mask];
+    }
+    void pop() { m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+private:
+    static size_t roundUp(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    std::vector<T> m_entries;
+    const size_t m_mask;
+    alignas(64) std::atomic<size_t> m_head{0}; // consumer
+    alignas(64) std::atomic<size_t> m_tail{0}; // producer
+};
+
+#endif // SPSCQUEUE_H
@@ -1625,6 +1625,13 @@ void ScriptEngine::attachSensorToEntity(const std::string& entityId, const std::
     hierarchy->attachSensors(QString::fromStdString(entityId), QString::fromStdString(sensorName));
 }
 
+float ScriptEngine::random()
+{
+    // Drawn from the simulation so lockstep runs stay reproducible
+    if (runtime && runtime->simulation) return static_cast<float>(runtime->simulation->random());
+    return Math_Random();
+}
+
 ScriptEngine::ScriptEngine()
 {
     // AngelScript setup
@@ -1632,7 +1639,7 @@ ScriptEngine::ScriptEngine()
     engine->SetMessageCallback(asFUNCTION(MessageCallback), 0, asCALL_CDECL);
 
     RegisterStdString(engine);
-    engine->RegisterGlobalFunction("float Random()", asFUNCTION(Math_Random), asCALL_CDECL);
+    engine->RegisterGlobalFunction("float Random()", asMETHOD(ScriptEngine, random), asCALL_THISCALL_ASGLOBAL, this);
 
     // Trigonometric functions
     engine->RegisterGlobalFunction("float Sin(float)", asFUNCTION(Math_Sin), asCALL_CDECL);
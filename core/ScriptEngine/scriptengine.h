@@ -156,6 +156,7 @@ public:
     void run();
     void setRuntime(Runtime* rt) { runtime = rt; }
     Runtime* getRuntime() const { return runtime; }
+    float random(); // script Random(): the simulation's seeded generator when available
 
 public slots:
     void ScriptSleep(int milliseconds);
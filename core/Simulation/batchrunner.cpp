@@ -0,0 +1,199 @@
+#include "batchrunner.h"
+#include "core/Hierarchy/hierarchy.h"
+#include "core/Simulation/simulation.h"
+#include "core/Simulation/ensemblerunner.h"
+#include "core/Simulation/statehashlog.h"
+#include "core/Recorder/recorder.h"
+#include "core/Recorder/recordingquery.h"
+#include "core/Recorder/recordingstatsreport.h"
+#include "core/Hierarchy/Utils/spatialbenchmark.h"
+#include <core/Debug/console.h>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <algorithm>
+#include <cmath>
+
+BatchRunner::BatchRunner(QObject* parent) : QObject(parent) {
+    hierarchy = new Hierarchy();
+    simulation = new Simulation();
+    recorder = new Recorder(hierarchy, simulation);
+
+    // Same physics wiring as Runtime, without the renderer and network layers
+    simulation->setHierarchy(hierarchy);
+    simulation->viewSyncEnabled = false; // no views to feed
+    connect(hierarchy, &Hierarchy::entityPhysicsAdded, simulation, &Simulation::entityAdded);
+    connect(hierarchy, &Hierarchy::entityPhysicsRemoved, simulation, &Simulation::entityRemoved);
+    connect(hierarchy, &Hierarchy::entityUpdate, simulation, &Simulation::entityUpdate);
+}
+
+BatchRunner::~BatchRunner() {
+    delete recorder;
+    delete simulation;
+    delete hierarchy;
+}
+
+bool BatchRunner::loadScenario(const QString& filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        Console::error("BatchRunner: failed to open scenario " + filePath.toStdString());
+        return false;
+    }
+    QJsonParseError err;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &err);
+    file.close();
+    if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+        Console::error("BatchRunner: failed to parse scenario: " + err.errorString().toStdString());
+        return false;
+    }
+
+    QJsonObject obj = doc.object();
+    if (!obj.contains("hierarchy") || !obj["hierarchy"].isObject()) {
+        Console::error("BatchRunner: scenario does not contain a 'hierarchy' key");
+        return false;
+    }
+    hierarchy->fromJson(obj["hierarchy"].toObject());
+    Console::log("BatchRunner: loaded " + std::to_string(hierarchy->Entities->size()) +
+                 " entities, " + std::to_string(simulation->physicsComponent.size()) + " simulated");
+    return true;
+}
+
+bool BatchRunner::run(const BatchOptions& options) {
+    if (options.timeStep <= 0.0 || options.duration <= 0.0) {
+        Console::error("BatchRunner: duration and time step must be positive");
+        return false;
+    }
+
+    const qint64 totalTicks = static_cast<qint64>(options.duration / options.timeStep + 0.5);
+    const float dt = static_cast<float>(options.timeStep);
+    simulation->kinematics.setDeferViews(true);
+
+    StateHashLog hashLog;
+    if (options.lockstep) {
+        simulation->setDeterministic(true, options.seed);
+        if (!options.hashLogPath.isEmpty()) {
+            if (!hashLog.open(options.hashLogPath)) return false;
+            simulation->hashLog = &hashLog;
+        }
+    }
+
+    if (options.record) {
+        const QString path = options.outputPath.isEmpty() ? Recorder::defaultRecordingPath() : options.outputPath;
+        const int interval = std::max(1, static_cast<int>(std::lround(options.recordInterval / options.timeStep)));
+        if (!recorder->startRecording(path, options.timeStep, interval)) return false;
+    }
+
+    QElapsedTimer wall;
+    wall.start();
+    for (qint64 tick = 0; tick < totalTicks; ++tick) {
+        simulation->tick(dt);
+    }
+    const double wallSeconds = wall.nsecsElapsed() / 1e9;
+    simulation->kinematics.setDeferViews(false);
+    simulation->hashLog = nullptr;
+    hashLog.close();
+    if (options.lockstep) {
+        Console::log("BatchRunner: lockstep state hash after tick " + std::to_string(simulation->tickCount()) +
+                     ": " + QString::number(simulation->stateHash(), 16).toStdString());
+    }
+
+    const double ticksPerSecond = wallSeconds > 0 ? totalTicks / wallSeconds : 0.0;
+    const double speedup = wallSeconds > 0 ? options.duration / wallSeconds : 0.0;
+    Console::log("BatchRunner: " + std::to_string(totalTicks) + " ticks in " +
+                 std::to_string(wallSeconds) + " s (" + std::to_string(ticksPerSecond) +
+                 " ticks/s, " + std::to_string(speedup) + "x real time)");
+
+    if (options.record) {
+        recorder->stopRecording();
+        const RecordingStreamStats stream = recorder->streamStats();
+        Console::log("BatchRunner: recording written to " + recorder->recordingPath().toStdString() + " (" +
+                     std::to_string(stream.bytesWritten) + " bytes, writer queue high water " +
+                     std::to_string(stream.highWater) + "/" + std::to_string(stream.capacity) + ", " +
+                     std::to_string(stream.stalls) + " stalls, " + std::to_string(stream.stallSeconds) + " s stalled)");
+    }
+    return true;
+}
+
+// Tools that share the headless entry point. Each lives next to the feature
+// it exercises and parses its own options; a tool's option selects it.
+struct BatchTool {
+    const char* option;
+    int (*exec)(const QStringList& arguments);
+};
+
+static const BatchTool batchTools[] = {
+    {"bench-spatial", &SpatialBenchmark::exec},
+    {"compare-hashes", &StateHashLog::exec},
+    {"ensemble", &EnsembleRunner::exec},
+    {"query", &RecordingQuery::exec},
+    {"recording-stats", &RecordingStatsReport::exec},
+};
+
+// Matches "--option", "--option=value" and the single dash form
+static bool isOption(const QString& argument, const char* option) {
+    QString name = argument;
+    if (name.startsWith("--")) name.remove(0, 2);
+    else if (name.startsWith('-')) name.remove(0, 1);
+    else return false;
+    return name.section('=', 0, 0) == QLatin1String(option);
+}
+
+static const BatchTool* findTool(const QStringList& arguments) {
+    for (const BatchTool& tool : batchTools) {
+        for (const QString& argument : arguments) {
+            if (isOption(argument, tool.option)) return &tool;
+        }
+    }
+    return nullptr;
+}
+
+bool BatchRunner::isBatchInvocation(int argc, char* argv[]) {
+    QStringList arguments;
+    for (int i = 1; i < argc; ++i) arguments << QString::fromLocal8Bit(argv[i]);
+    if (findTool(arguments)) return true;
+    for (const QString& argument : arguments) {
+        if (isOption(argument, "batch")) return true;
+    }
+    return false;
+}
+
+int BatchRunner::exec(const QStringList& arguments) {
+    if (const BatchTool* tool = findTool(arguments)) return tool->exec(arguments);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("TDF headless batch runner. Other tools: --bench-spatial, --compare-hashes, "
+                                     "--ensemble, --query and --recording-stats, each with its own --help.");
+    parser.addHelpOption();
+    QCommandLineOption batchOption("batch", "Scenario JSON to run headless.", "scenario");
+    QCommandLineOption durationOption("duration", "Simulated seconds to run (default 60).", "seconds", "60");
+    QCommandLineOption stepOption("dt", "Fixed time step in seconds (default 1/60).", "seconds");
+    QCommandLineOption outputOption("output", "Recording output file.", "file");
+    QCommandLineOption intervalOption("record-interval", "Simulated seconds between recorded ticks, rounded to whole steps (default 0.1).", "seconds", "0.1");
+    QCommandLineOption noRecordOption("no-record", "Do not write a recording.");
+    QCommandLineOption threadsOption("threads", "Worker threads for entity updates (default: one per core).", "count", "-1");
+    QCommandLineOption seedOption("seed", "Lockstep RNG seed (default 1).", "seed", "1");
+    QCommandLineOption lockstepOption("lockstep", "Deterministic mode: seeded RNG, ID-ordered updates and a per-tick state hash.");
+    QCommandLineOption hashLogOption("hash-log", "Write per-tick lockstep state hashes to this file (implies --lockstep).", "file");
+    parser.addOptions({batchOption, durationOption, stepOption, outputOption, intervalOption, noRecordOption, threadsOption,
+                       seedOption, lockstepOption, hashLogOption});
+    parser.process(arguments);
+
+    BatchRunner runner;
+    BatchOptions options;
+    options.scenarioPath = parser.value(batchOption);
+    options.duration = parser.value(durationOption).toDouble();
+    options.timeStep = parser.isSet(stepOption) ? parser.value(stepOption).toDouble()
+                                                : 1.0 / runner.simulation->PhysicsUpdateFrameRate;
+    options.outputPath = parser.value(outputOption);
+    options.recordInterval = parser.value(intervalOption).toDouble();
+    options.record = !parser.isSet(noRecordOption);
+    options.hashLogPath = parser.value(hashLogOption);
+    options.lockstep = parser.isSet(lockstepOption) || !options.hashLogPath.isEmpty();
+    options.seed = parser.value(seedOption).toULongLong();
+    runner.simulation->setWorkerCount(parser.value(threadsOption).toInt());
+
+    if (!runner.loadScenario(options.scenarioPath)) return 1;
+    return runner.run(options) ? 0 : 1;
+}
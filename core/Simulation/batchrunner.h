@@ -0,0 +1,47 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class Hierarchy;
+class Simulation;
+class Recorder;
+
+struct BatchOptions {
+    QString scenarioPath;
+    QString outputPath;          // empty = default recordings folder
+    double duration = 60.0;      // simulated seconds
+    double timeStep = 1.0 / 60;  // fixed physics step in seconds
+    double recordInterval = 0.1; // simulated seconds between recorded ticks
+    bool record = true;
+    bool lockstep = false;       // deterministic mode with a per-tick state hash
+    quint64 seed = 1;            // lockstep RNG seed
+    QString hashLogPath;         // lockstep hash log, empty = none
+};
+
+// Headless runner: loads a scenario into its own Hierarchy/Simulation pair and
+// drives it in a tight fixed-step loop. No widgets, canvas, GIS or 3D view is
+// created, so it can run under a QCoreApplication on a server.
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BatchRunner(QObject* parent = nullptr);
+    ~BatchRunner();
+
+    Hierarchy* hierarchy;
+    Simulation* simulation;
+    Recorder* recorder;
+
+    bool loadScenario(const QString& filePath);
+    bool run(const BatchOptions& options);
+
+    // Entry point used by main() when "--batch" or one of the tools in
+    // batchrunner.cpp's table is on the command line.
+    static bool isBatchInvocation(int argc, char* argv[]);
+    static int exec(const QStringList& arguments);
+};
+
+#endif // BATCHRUNNER_H
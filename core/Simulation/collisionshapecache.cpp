@@ -0,0 +1,59 @@
+#include "collisionshapecache.h"
+#include <cmath>
+
+static qint32 quantise(btScalar v) {
+    return static_cast<qint32>(std::lround(v * 1000.0));
+}
+
+size_t CollisionShapeCache::KeyHash::operator()(const Key& k) const {
+    size_t h = std::hash<int>()(k.type);
+    h = h * 31 + std::hash<qint32>()(k.x);
+    h = h * 31 + std::hash<qint32>()(k.y);
+    h = h * 31 + std::hash<qint32>()(k.z);
+    return h;
+}
+
+CollisionShapeCache::~CollisionShapeCache() {
+    for (auto& [key, entry] : m_entries) delete entry.shape;
+}
+
+btCollisionShape* CollisionShapeCache::acquire(Constants::ColliderType type, const btVector3& halfExtents, btScalar radius) {
+    Key key{static_cast<int>(type), 0, 0, 0};
+    if (type == Constants::ColliderType::Box) {
+        key.x = quantise(halfExtents.x());
+        key.y = quantise(halfExtents.y());
+        key.z = quantise(halfExtents.z());
+    } else if (type == Constants::ColliderType::Sphere) {
+        key.x = quantise(radius);
+    } else {
+        return nullptr;
+    }
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        it->second.refs++;
+        return it->second.shape;
+    }
+
+    btCollisionShape* shape = nullptr;
+    if (type == Constants::ColliderType::Box) {
+        shape = new btBoxShape(btVector3(key.x, key.y, key.z) / 1000.0);
+    } else {
+        shape = new btSphereShape(key.x / 1000.0);
+    }
+    m_entries[key] = Entry{shape, 1};
+    m_keys[shape] = key;
+    return shape;
+}
+
+void CollisionShapeCache::release(btCollisionShape* shape) {
+    auto keyIt = m_keys.find(shape);
+    if (keyIt == m_keys.end()) return;
+
+    auto it = m_entries.find(keyIt->second);
+    if (--it->second.refs > 0) return;
+
+    delete shape;
+    m_entries.erase(it);
+    m_keys.erase(keyIt);
+}
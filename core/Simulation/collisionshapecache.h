@@ -0,0 +1,41 @@
+#ifndef COLLISIONSHAPECACHE_H
+#define COLLISIONSHAPECACHE_H
+
+#include <btBulletDynamicsCommon.h>
+#include <core/Hierarchy/Struct/constants.h>
+#include <QtGlobal>
+#include <unordered_map>
+
+// Reference-counted Bullet shapes keyed on collider type and world-space
+// dimensions (quantised to millimetres), so identical platforms share one
+// shape instead of each owning a rescaled unit box.
+class CollisionShapeCache
+{
+public:
+    ~CollisionShapeCache();
+
+    // Box uses halfExtents, Sphere uses radius; other types return nullptr
+    btCollisionShape* acquire(Constants::ColliderType type, const btVector3& halfExtents, btScalar radius);
+    void release(btCollisionShape* shape);
+
+    int size() const { return static_cast<int>(m_entries.size()); }
+
+private:
+    struct Key {
+        int type;
+        qint32 x, y, z;
+        bool operator==(const Key& o) const { return type == o.type && x == o.x && y == o.y && z == o.z; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const;
+    };
+    struct Entry {
+        btCollisionShape* shape;
+        int refs;
+    };
+
+    std::unordered_map<Key, Entry, KeyHash> m_entries;
+    std::unordered_map<btCollisionShape*, Key> m_keys;
+};
+
+#endif // COLLISIONSHAPECACHE_H
@@ -0,0 +1,302 @@
+#include "ensemblerunner.h"
+#include "core/Hierarchy/hierarchy.h"
+#include "core/Simulation/simulation.h"
+#include "core/Simulation/jobsystem.h"
+#include "core/Hierarchy/EntityProfiles/sensor.h"
+#include <core/Debug/console.h>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <algorithm>
+#include <limits>
+#include <random>
+
+enum Metric { Tracks, EwTracks, PeakTracks, FirstDetection, TrackSeconds, MetricCount };
+
+QStringList EnsembleRunner::availableMetrics() {
+    // Same order as the Metric enum
+    return {"tracks", "ewtracks", "peak_tracks", "first_detection_s", "track_seconds"};
+}
+
+bool EnsembleParameter::parse(const QString& spec, EnsembleParameter& out) {
+    const int eq = spec.indexOf('=');
+    const int dot = spec.indexOf('.');
+    if (eq < 0 || dot <= 0 || dot > eq) return false;
+    out = EnsembleParameter();
+    out.profileType = spec.left(dot);
+    out.key = spec.mid(dot + 1, eq - dot - 1);
+    const QString range = spec.mid(eq + 1);
+    bool ok = true;
+    if (range.contains(':')) {
+        const QStringList bounds = range.split(':');
+        if (bounds.size() != 2) return false;
+        bool okMax = true;
+        out.minValue = bounds[0].toDouble(&ok);
+        out.maxValue = bounds[1].toDouble(&okMax);
+        return ok && okMax && !out.key.isEmpty();
+    }
+    for (const QString& v : range.split(',', Qt::SkipEmptyParts)) {
+        out.values.push_back(v.toDouble(&ok));
+        if (!ok) return false;
+    }
+    return !out.values.isEmpty() && !out.key.isEmpty();
+}
+
+// splitmix64, so neighbouring replica indices get unrelated seeds
+static quint64 replicaSeed(quint64 base, int index) {
+    quint64 z = base + 0x9E3779B97F4A7C15ull * static_cast<quint64>(index + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Sets key on every entity of a profile or folder node that already has it
+static QJsonObject patchEntities(QJsonObject node, const QString& key, double value, int& patched) {
+    if (node["entities"].isObject()) {
+        QJsonObject entities = node["entities"].toObject();
+        for (const QString& id : entities.keys()) {
+            QJsonObject entity = entities[id].toObject();
+            if (!entity.contains(key)) continue;
+            entity[key] = value;
+            entities[id] = entity;
+            patched++;
+        }
+        node["entities"] = entities;
+    }
+    if (node["folders"].isObject()) {
+        QJsonObject folders = node["folders"].toObject();
+        for (const QString& id : folders.keys()) {
+            folders[id] = patchEntities(folders[id].toObject(), key, value, patched);
+        }
+        node["folders"] = folders;
+    }
+    return node;
+}
+
+// Overrides are applied to the JSON before the replica loads it: entity
+// fromJson resets fields that are missing, so patching live objects would not do.
+static QJsonObject applyParameter(QJsonObject hierarchyJson, const EnsembleParameter& parameter, double value, int& patched) {
+    QJsonObject profiles = hierarchyJson["profileCategories"].toObject();
+    for (const QString& id : profiles.keys()) {
+        QJsonObject profile = profiles[id].toObject();
+        const QString type = profile["type"].toObject()["value"].toString();
+        if (type.compare(parameter.profileType, Qt::CaseInsensitive) != 0) continue;
+        profiles[id] = patchEntities(profile, parameter.key, value, patched);
+    }
+    hierarchyJson["profileCategories"] = profiles;
+    return hierarchyJson;
+}
+
+bool EnsembleRunner::loadScenario(const QString& filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        Console::error("EnsembleRunner: failed to open scenario " + filePath.toStdString());
+        return false;
+    }
+    QJsonParseError err;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &err);
+    file.close();
+    if (err.error != QJsonParseError::NoError || !doc.isObject() || !doc.object()["hierarchy"].isObject()) {
+        Console::error("EnsembleRunner: scenario is not valid JSON with a 'hierarchy' key");
+        return false;
+    }
+    m_hierarchyJson = doc.object()["hierarchy"].toObject();
+    return true;
+}
+
+EnsembleRunner::Result EnsembleRunner::runReplica(int index, const EnsembleOptions& options) const {
+    Result result;
+    result.seed = replicaSeed(options.seed, index);
+    std::mt19937_64 rng(result.seed);
+
+    QJsonObject scenario = m_hierarchyJson;
+    for (const EnsembleParameter& parameter : options.parameters) {
+        double value;
+        if (!parameter.values.isEmpty()) {
+            value = parameter.values[index % parameter.values.size()];
+        } else {
+            value = std::uniform_real_distribution<double>(parameter.minValue, parameter.maxValue)(rng);
+        }
+        int patched = 0;
+        scenario = applyParameter(scenario, parameter, value, patched);
+        result.parameters.push_back(value);
+    }
+
+    QElapsedTimer wall;
+    wall.start();
+
+    // Created and destroyed on this thread, which keeps the registry maps private
+    Hierarchy* hierarchy = new Hierarchy();
+    Simulation* simulation = new Simulation(0); // replicas are the unit of parallelism
+    simulation->setHierarchy(hierarchy);
+    simulation->viewSyncEnabled = false;
+    simulation->seedRandom(result.seed);
+    QObject::connect(hierarchy, &Hierarchy::entityPhysicsAdded, simulation, &Simulation::entityAdded);
+    QObject::connect(hierarchy, &Hierarchy::entityPhysicsRemoved, simulation, &Simulation::entityRemoved);
+    QObject::connect(hierarchy, &Hierarchy::entityUpdate, simulation, &Simulation::entityUpdate);
+    hierarchy->fromJson(scenario);
+
+    std::vector<Sensor*> sensors;
+    for (auto& [id, entity] : *hierarchy->Entities) {
+        if (Sensor* sensor = dynamic_cast<Sensor*>(entity)) sensors.push_back(sensor);
+    }
+
+    result.metrics = QVector<double>(MetricCount, 0.0);
+    result.metrics[FirstDetection] = -1.0;
+    const qint64 totalTicks = static_cast<qint64>(options.duration / options.timeStep + 0.5);
+    const float dt = static_cast<float>(options.timeStep);
+
+    simulation->kinematics.setDeferViews(true);
+    for (qint64 tick = 0; tick < totalTicks; ++tick) {
+        simulation->tick(dt);
+
+        double tracks = 0.0;
+        double ewtracks = 0.0;
+        for (Sensor* sensor : sensors) {
+            tracks += sensor->targets.size();
+            ewtracks += sensor->ewtargets.size();
+        }
+        result.metrics[Tracks] = tracks;
+        result.metrics[EwTracks] = ewtracks;
+        result.metrics[PeakTracks] = std::max(result.metrics[PeakTracks], tracks);
+        result.metrics[TrackSeconds] += tracks * options.timeStep;
+        if (tracks > 0 && result.metrics[FirstDetection] < 0) {
+            result.metrics[FirstDetection] = (tick + 1) * options.timeStep;
+        }
+    }
+    simulation->kinematics.setDeferViews(false);
+
+    delete simulation;
+    delete hierarchy;
+    result.wallSeconds = wall.nsecsElapsed() / 1e9;
+    return result;
+}
+
+bool EnsembleRunner::run(const EnsembleOptions& options) {
+    if (options.replicas <= 0 || options.timeStep <= 0.0 || options.duration <= 0.0) {
+        Console::error("EnsembleRunner: replicas, duration and time step must be positive");
+        return false;
+    }
+    if (options.replicas > 1 && options.parameters.isEmpty()) {
+        Console::warning("EnsembleRunner: without --vary every replica runs the same scenario");
+    }
+    for (const QString& metric : options.metrics) {
+        if (!availableMetrics().contains(metric)) {
+            Console::error("EnsembleRunner: unknown metric " + metric.toStdString() +
+                           " (available: " + availableMetrics().join(", ").toStdString() + ")");
+            return false;
+        }
+    }
+    for (const EnsembleParameter& parameter : options.parameters) {
+        int patched = 0;
+        applyParameter(m_hierarchyJson, parameter, 0.0, patched);
+        if (patched == 0) {
+            Console::warning("EnsembleRunner: " + parameter.label().toStdString() + " matches no entity");
+        }
+    }
+
+    std::vector<Result> results(options.replicas); // one slot per replica, no locking
+    JobSystem pool(options.threads);
+    QElapsedTimer wall;
+    wall.start();
+    // Grain 1: a replica is far larger than the cost of handing it out
+    pool.parallelFor(options.replicas, 1, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) results[i] = runReplica(i, options);
+    });
+    const double wallSeconds = wall.nsecsElapsed() / 1e9;
+
+    double cpuSeconds = 0.0;
+    for (const Result& r : results) cpuSeconds += r.wallSeconds;
+    Console::log("EnsembleRunner: " + std::to_string(options.replicas) + " replicas on " +
+                 std::to_string(pool.workerCount() + 1) + " threads in " + std::to_string(wallSeconds) +
+                 " s (" + std::to_string(wallSeconds > 0 ? cpuSeconds / wallSeconds : 0.0) + "x parallel)");
+
+    const QStringList names = availableMetrics();
+    for (int m = 0; m < names.size(); ++m) {
+        if (!options.metrics.isEmpty() && !options.metrics.contains(names[m])) continue;
+        double sum = 0.0;
+        double lo = std::numeric_limits<double>::max();
+        double hi = std::numeric_limits<double>::lowest();
+        for (const Result& r : results) {
+            sum += r.metrics[m];
+            lo = std::min(lo, r.metrics[m]);
+            hi = std::max(hi, r.metrics[m]);
+        }
+        Console::log("  " + names[m].toStdString() + ": mean " + std::to_string(sum / results.size()) +
+                     ", min " + std::to_string(lo) + ", max " + std::to_string(hi));
+    }
+    return writeResults(options, results);
+}
+
+bool EnsembleRunner::writeResults(const EnsembleOptions& options, const std::vector<Result>& results) const {
+    const QString path = options.outputPath.isEmpty() ? QString("ensemble_results.csv") : options.outputPath;
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        Console::error("EnsembleRunner: failed to write " + path.toStdString());
+        return false;
+    }
+
+    const QStringList names = availableMetrics();
+    QVector<int> columns;
+    for (int m = 0; m < names.size(); ++m) {
+        if (options.metrics.isEmpty() || options.metrics.contains(names[m])) columns.push_back(m);
+    }
+
+    QTextStream out(&file);
+    out << "replica,seed";
+    for (const EnsembleParameter& parameter : options.parameters) out << ',' << parameter.label();
+    for (int m : columns) out << ',' << names[m];
+    out << ",wall_s\n";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << i << ',' << r.seed;
+        for (double value : r.parameters) out << ',' << value;
+        for (int m : columns) out << ',' << r.metrics[m];
+        out << ',' << r.wallSeconds << '\n';
+    }
+    file.close();
+    Console::log("EnsembleRunner: results written to " + path.toStdString());
+    return true;
+}
+
+int EnsembleRunner::exec(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("TDF ensemble runner");
+    parser.addHelpOption();
+    QCommandLineOption batchOption("batch", "Scenario JSON every replica loads.", "scenario");
+    QCommandLineOption ensembleOption("ensemble", "Number of independent replicas, run in parallel. Replicas differ only through --vary.", "count");
+    QCommandLineOption varyOption("vary", "Per-replica override, ProfileType.key=min:max (uniform) or =a,b,c (sweep). Repeatable.", "spec");
+    QCommandLineOption metricsOption("metrics", "Comma separated metrics (default all): " + availableMetrics().join(", ") + ".", "names");
+    QCommandLineOption seedOption("seed", "Base seed for the --vary min:max draws (default 1).", "seed", "1");
+    QCommandLineOption durationOption("duration", "Simulated seconds per replica (default 60).", "seconds", "60");
+    QCommandLineOption stepOption("dt", "Fixed time step in seconds (default 1/60).", "seconds");
+    QCommandLineOption threadsOption("threads", "Replica threads (default: one per core).", "count", "-1");
+    QCommandLineOption outputOption("output", "CSV results file, one row per replica.", "file");
+    parser.addOptions({batchOption, ensembleOption, varyOption, metricsOption, seedOption, durationOption, stepOption,
+                       threadsOption, outputOption});
+    parser.process(arguments);
+
+    EnsembleOptions options;
+    options.replicas = parser.value(ensembleOption).toInt();
+    options.threads = parser.value(threadsOption).toInt();
+    options.duration = parser.value(durationOption).toDouble();
+    options.timeStep = parser.isSet(stepOption) ? parser.value(stepOption).toDouble() : 1.0 / 60;
+    options.seed = parser.value(seedOption).toULongLong();
+    options.outputPath = parser.value(outputOption);
+    options.metrics = parser.value(metricsOption).split(',', Qt::SkipEmptyParts);
+    for (const QString& spec : parser.values(varyOption)) {
+        EnsembleParameter parameter;
+        if (!EnsembleParameter::parse(spec, parameter)) {
+            Console::error("EnsembleRunner: bad --vary " + spec.toStdString());
+            return 1;
+        }
+        options.parameters.push_back(parameter);
+    }
+
+    EnsembleRunner runner;
+    if (!runner.loadScenario(parser.value(batchOption))) return 1;
+    return runner.run(options) ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+#ifndef ENSEMBLERUNNER_H
+#define ENSEMBLERUNNER_H
+
+#include <QJsonObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <vector>
+
+// One "--vary" override, e.g. "Sensor.range=50:150" (uniform per replica) or
+// "Weapon.proximityRange=5,10,20" (replica i takes value i % n). The left part
+// is the profile type and the JSON key set on every entity of that profile.
+struct EnsembleParameter {
+    QString profileType;
+    QString key;
+    QVector<double> values;
+    double minValue = 0.0;
+    double maxValue = 0.0;
+
+    QString label() const { return profileType + "." + key; }
+    static bool parse(const QString& spec, EnsembleParameter& out);
+};
+
+struct EnsembleOptions {
+    int replicas = 8;
+    int threads = -1;            // -1 = one per core
+    double duration = 60.0;      // simulated seconds per replica
+    double timeStep = 1.0 / 60;  // fixed physics step in seconds
+    quint64 seed = 1;            // replica i's seed, derived from seed and i, draws its min:max values
+    QVector<EnsembleParameter> parameters;
+    QStringList metrics;         // empty = every metric
+    QString outputPath;          // CSV, one row per replica
+};
+
+// Monte Carlo runner: every replica builds its own Hierarchy and Simulation
+// from the same scenario JSON on the worker thread that runs it, so replicas
+// share no entities, physics worlds or registry maps and run in parallel.
+// The built-in models are deterministic: replicas differ only through the
+// --vary parameters, the seed picks the values drawn for min:max ranges.
+class EnsembleRunner
+{
+public:
+    bool loadScenario(const QString& filePath);
+    bool run(const EnsembleOptions& options);
+
+    static QStringList availableMetrics();
+
+    // "--batch scenario --ensemble N" on the headless entry point
+    static int exec(const QStringList& arguments);
+
+private:
+    struct Result {
+        quint64 seed = 0;
+        QVector<double> parameters;
+        QVector<double> metrics; // in availableMetrics() order
+        double wallSeconds = 0.0;
+    };
+
+    Result runReplica(int index, const EnsembleOptions& options) const;
+    bool writeResults(const EnsembleOptions& options, const std::vector<Result>& results) const;
+
+    QJsonObject m_hierarchyJson;
+};
+
+#endif // ENSEMBLERUNNER_H
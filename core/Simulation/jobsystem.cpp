@@ -0,0 +1,102 @@
+#include "jobsystem.h"
+#include <algorithm>
+
+static thread_local bool insideJob = false;
+
+JobSystem::JobSystem(int threadCount) {
+    if (threadCount < 0) {
+        threadCount = std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+    }
+    for (int i = 0; i <= threadCount; ++i) m_queues.push_back(std::make_unique<Queue>());
+    for (int i = 0; i < threadCount; ++i) m_threads.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_threads) t.join();
+}
+
+void JobSystem::parallelFor(int count, int grain, const std::function<void(int, int)>& fn) {
+    if (count <= 0) return;
+    grain = std::max(1, grain);
+    if (m_threads.empty() || insideJob || count <= grain) {
+        fn(0, count);
+        return;
+    }
+
+    Batch batch;
+    const int queueCount = static_cast<int>(m_queues.size());
+    int target = 0;
+    for (int begin = 0; begin < count; begin += grain) {
+        Task task{&fn, begin, std::min(count, begin + grain), &batch};
+        batch.pending++;
+        m_queued++;
+        Queue& q = *m_queues[target];
+        {
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.tasks.push_back(task);
+        }
+        target = (target + 1) % queueCount;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_all();
+
+    // The caller works from its own queue (the last one) and steals the rest
+    const int self = queueCount - 1;
+    while (batch.pending.load() > 0) {
+        if (!runOne(self)) std::this_thread::yield();
+    }
+    if (batch.error) std::rethrow_exception(batch.error);
+}
+
+bool JobSystem::runOne(int self) {
+    Task task{};
+    bool found = false;
+    {
+        Queue& own = *m_queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+    const int queueCount = static_cast<int>(m_queues.size());
+    for (int i = 1; !found && i < queueCount; ++i) {
+        Queue& victim = *m_queues[(self + i) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            found = true;
+        }
+    }
+    if (!found) return false;
+
+    m_queued--;
+    const bool nested = insideJob;
+    insideJob = true;
+    try {
+        (*task.fn)(task.begin, task.end);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(task.batch->errorMutex);
+        if (!task.batch->error) task.batch->error = std::current_exception();
+    }
+    insideJob = nested;
+    task.batch->pending.fetch_sub(1);
+    return true;
+}
+
+void JobSystem::workerLoop(int index) {
+    while (!m_stopping) {
+        if (runOne(index)) continue;
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait(lock, [this]() { return m_stopping || m_queued.load() > 0; });
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small work-stealing pool for data-parallel simulation phases. Each worker
+// owns a deque, pops its own work from the back and steals from the front of
+// the others; the calling thread joins in until the batch is finished.
+class JobSystem
+{
+public:
+    // threadCount < 0 picks hardware_concurrency - 1; 0 runs everything inline
+    explicit JobSystem(int threadCount = -1);
+    ~JobSystem();
+
+    int workerCount() const { return static_cast<int>(m_threads.size()); }
+
+    // Calls fn(begin, end) over [0, count) in chunks of about grain items and
+    // returns once every chunk has run. Nested calls run inline. If chunks
+    // throw, the first exception is rethrown after all of them have finished.
+    void parallelFor(int count, int grain, const std::function<void(int, int)>& fn);
+
+private:
+    struct Batch {
+        std::atomic<int> pending{0};
+        std::mutex errorMutex;
+        std::exception_ptr error; // first exception thrown by a chunk
+    };
+    struct Task {
+        const std::function<void(int, int)>* fn;
+        int begin;
+        int end;
+        Batch* batch;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool runOne(int self);
+    void workerLoop(int index);
+
+    std::vector<std::unique_ptr<Queue>> m_queues; // one per worker plus the caller's
+    std::vector<std::thread> m_threads;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<int> m_queued{0};
+    std::atomic<bool> m_stopping{false};
+};
+
+#endif // JOBSYSTEM_H
@@ -0,0 +1,66 @@
+#include "kinematicstore.h"
+#include <core/Hierarchy/Components/transform.h>
+
+int KinematicStore::attach(Transform* transform) {
+    if (transform->kinematicStore == this) return transform->kinematicSlot;
+    if (transform->kinematicStore) transform->kinematicStore->detach(transform);
+
+    const int slot = size();
+    positions.push_back(transform->matrix->translation());
+    orientations.push_back(transform->matrix->rotation());
+    velocities.push_back(QVector3D());
+    scales.push_back(transform->matrix->scale3D());
+    owners.push_back(transform);
+
+    transform->kinematicStore = this;
+    transform->kinematicSlot = slot;
+    return slot;
+}
+
+// Swap-remove keeps the columns dense; the moved owner learns its new slot
+void KinematicStore::detach(Transform* transform) {
+    if (transform->kinematicStore != this) return;
+    const int slot = transform->kinematicSlot;
+    syncView(slot);
+
+    const int last = size() - 1;
+    if (slot != last) {
+        positions[slot] = positions[last];
+        orientations[slot] = orientations[last];
+        velocities[slot] = velocities[last];
+        scales[slot] = scales[last];
+        owners[slot] = owners[last];
+        owners[slot]->kinematicSlot = slot;
+    }
+    positions.pop_back();
+    orientations.pop_back();
+    velocities.pop_back();
+    scales.pop_back();
+    owners.pop_back();
+
+    transform->kinematicStore = nullptr;
+    transform->kinematicSlot = -1;
+}
+
+void KinematicStore::clear() {
+    while (!owners.empty()) detach(owners.back());
+}
+
+void KinematicStore::setDeferViews(bool defer) {
+    if (m_deferViews && !defer) syncViews();
+    m_deferViews = defer;
+}
+
+void KinematicStore::syncViews() {
+    for (int slot = 0; slot < size(); ++slot) syncView(slot);
+}
+
+void KinematicStore::syncView(int slot) {
+    Qt3DCore::QTransform* view = owners[slot]->matrix;
+    // QTransform ignores unchanged values, so idle entities emit nothing
+    m_syncing = true;
+    view->setTranslation(positions[slot]);
+    view->setRotation(orientations[slot]);
+    view->setScale3D(scales[slot]);
+    m_syncing = false;
+}
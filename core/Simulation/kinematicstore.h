@@ -0,0 +1,41 @@
+#ifndef KINEMATICSTORE_H
+#define KINEMATICSTORE_H
+
+#include <QVector3D>
+#include <QQuaternion>
+#include <vector>
+
+class Transform;
+
+// Structure-of-arrays kinematic state for every simulated Transform, indexed
+// by a dense slot. While a Transform is attached its accessors read and write
+// these columns; the Qt3D QTransform is only a view refreshed by syncViews().
+class KinematicStore
+{
+public:
+    std::vector<QVector3D> positions;
+    std::vector<QQuaternion> orientations;
+    std::vector<QVector3D> velocities;
+    std::vector<QVector3D> scales;
+    std::vector<Transform*> owners;
+
+    int attach(Transform* transform);   // copies the current view state in
+    void detach(Transform* transform);  // writes the state back to the view
+    void clear();
+    int size() const { return static_cast<int>(owners.size()); }
+
+    // When deferred, setters only touch the store and views catch up in
+    // syncViews(); otherwise every write is mirrored to the view at once.
+    void setDeferViews(bool defer);
+    bool deferViews() const { return m_deferViews; }
+
+    void syncViews();
+    void syncView(int slot);
+    bool isSyncing() const { return m_syncing; }
+
+private:
+    bool m_deferViews = false;
+    bool m_syncing = false;
+};
+
+#endif // KINEMATICSTORE_H
@@ -2,10 +2,38 @@
 #include "simulation.h"
 #include <algorithm>
 #include <core/Debug/console.h>
+#include <core/Hierarchy/hierarchy.h>
 #include <QJsonObject>
 #include <QtMath>
+#include <cmath>
+#include <cstring>
 
-Simulation::Simulation() {
+// Entities per job in the parallel update phases
+static const int PARALLEL_GRAIN = 64;
+
+// FNV-1a over 32-bit words for the lockstep state hash
+static const quint64 HASH_OFFSET = 0xcbf29ce484222325ull;
+static const quint64 HASH_PRIME = 0x100000001b3ull;
+
+static inline void hashWord(quint64& h, quint32 word) {
+    h ^= word;
+    h *= HASH_PRIME;
+}
+
+static inline void hashFloat(quint64& h, float v) {
+    v += 0.0f; // -0 and +0 hash the same
+    quint32 bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    hashWord(h, bits);
+}
+
+static inline void hashVector(quint64& h, const QVector3D& v) {
+    hashFloat(h, v.x());
+    hashFloat(h, v.y());
+    hashFloat(h, v.z());
+}
+
+Simulation::Simulation(int workerThreads) {
     updateTimer = new QTimer(this);
     elapsedTimer = new QElapsedTimer();
     elapsedTimer->start();
@@ -19,6 +47,8 @@ Simulation::Simulation() {
     complete = false;
     isReplaying = false;
     replayIndex = 0;
+    jobs = new JobSystem(workerThreads);
+    rng.seed(std::random_device()());
 
     connect(updateTimer, &QTimer::timeout, this, [=]() {
         if (isReplaying) {
@@ -48,10 +78,12 @@ Simulation::Simulation() {
 }
 
 Simulation::~Simulation() {
+    kinematics.clear();
+    delete jobs;
     for (auto& [id, body] : bulletBodies) {
         dynamicsWorld->removeRigidBody(body);
         delete body->getMotionState();
-        delete body->getCollisionShape();
+        shapeCache.release(body->getCollisionShape());
         delete body;
     }
     delete dynamicsWorld;
@@ -62,75 +94,231 @@ Simulation::~Simulation() {
     delete Gravity;
 }
 
+// Accumulator scheduler: wall time (scaled by speed) feeds fixed physics
+// substeps, while Update/Render are emitted at UIUpdateFrameRate only.
 void Simulation::frame() {
-    qint64 currentTime = elapsedTimer->elapsed();
-    deltaTime = (currentTime - lastTime) / 1000.0f;
+    qint64 currentTime = elapsedTimer->nsecsElapsed();
+    double frameTime = (currentTime - lastTime) / 1e9;
     lastTime = currentTime;
-    calculatePhysics();
+    stats.frames++;
+    stats.wallTime += frameTime * speed;
 
-    QJsonObject frameData;
-    QJsonArray entitiesArray;
-    for (const auto& [id, comp] : physicsComponent) {
-        if (!comp.transform) continue;
-
-        QJsonObject entityFrame;
-        entityFrame["id"] = QString::fromStdString(id);
-        entityFrame["position"] = QJsonObject{
-            {"x", comp.transform->matrix->translation().x()},
-            {"y", comp.transform->matrix->translation().y()},
-            {"z", comp.transform->matrix->translation().z()}
-        };
-        entityFrame["rotation"] = QJsonObject{
-            {"x", comp.transform->toEulerAngles().x()},
-            {"y", comp.transform->toEulerAngles().y()},
-            {"z", comp.transform->toEulerAngles().z()}
-        };
-
-        entitiesArray.append(entityFrame);
+    // A long stall (debugger, modal dialog) is dropped, not replayed
+    if (frameTime > MaxFrameTime) {
+        stats.droppedTime += (frameTime - MaxFrameTime) * speed;
+        frameTime = MaxFrameTime;
     }
 
-    frameData["entities"] = entitiesArray;
-    frameData["timestamp"] = QDateTime::currentMSecsSinceEpoch();
+    accumulator += frameTime * speed;
 
-    if (recorder) {
-        recorder->recordFrame(frameData);
+    const double step = 1.0 / PhysicsUpdateFrameRate;
+    const int maxSteps = static_cast<int>(std::ceil(MaxSubSteps * std::max(1.0f, speed)));
+    int steps = 0;
+    while (accumulator >= step && steps < maxSteps) {
+        tick(static_cast<float>(step));
+        accumulator -= step;
+        steps++;
+    }
+    if (accumulator >= step) {
+        // Still behind after the catch-up limit: keep the fractional part only
+        const double remainder = std::fmod(accumulator, step);
+        stats.droppedTime += accumulator - remainder;
+        accumulator = remainder;
+        stats.catchUpClamps++;
+    }
+    stats.physicsSteps += steps;
+    stats.simulatedTime += steps * step;
+    renderSimTime += steps * step;
+
+    renderAccumulator += frameTime;
+    if (renderAccumulator >= 1.0 / UIUpdateFrameRate) {
+        renderAccumulator = std::fmod(renderAccumulator, 1.0 / UIUpdateFrameRate);
+        const float renderDelta = static_cast<float>(renderSimTime);
+        renderSimTime = 0;
+        stats.renders++;
+        if (viewSyncEnabled) kinematics.syncViews();
+        QTimer::singleShot(0, this, [=]() {
+            emit Update();
+            emit Render(renderDelta);
+        });
     }
-
-    QTimer::singleShot(0, this, [=]() {
-        emit Update();
-        emit Render(deltaTime * speed);
-    });
     isPlay = true;
 }
 
 void Simulation::start() {
-    lastTime = elapsedTimer->elapsed();
+    lastTime = elapsedTimer->nsecsElapsed();
+    accumulator = 0;
+    renderAccumulator = 0;
+    renderSimTime = 0;
+    kinematics.setDeferViews(true);
+    updateTimer->setTimerType(Qt::PreciseTimer);
     updateTimer->start(1000 / SimulationFrameRate);
     isPlay = true;
 }
 
 void Simulation::pause() {
     updateTimer->stop();
+    kinematics.setDeferViews(false);
     isPlay = false;
 }
 
 void Simulation::stop() {
     updateTimer->stop();
+    kinematics.setDeferViews(false);
     isPlay = false;
     complete = true;
+
+    Console::log("Scheduler: " + std::to_string(stats.physicsSteps) + " physics steps, " +
+                 std::to_string(stats.renders) + " renders, " +
+                 std::to_string(stats.catchUpClamps) + " catch-up clamps, dropped " +
+                 std::to_string(stats.droppedTime) + " s, drift " + std::to_string(stats.drift()) + " s");
 }
 
+// Speed scales the simulated time fed to the accumulator, so models advance
+// through more fixed steps instead of taking larger ones
 void Simulation::setSpeed(float value) {
     speed = value;
-    for (auto& [id, comp] : physicsComponent) {
-        if (comp.dynamicModel) {
-            comp.dynamicModel->setMoveSpeed(value);
-        }
-    }
     emit speedUpdated(value);
 }
 void Simulation::nextStep() {
-    frame();
+    // Single step while paused: exactly one physics step and one UI update
+    const float step = 1.0f / PhysicsUpdateFrameRate;
+    tick(step);
+    stats.physicsSteps++;
+    stats.simulatedTime += step;
+    if (viewSyncEnabled) kinematics.syncViews();
+    emit Update();
+    emit Render(step);
+}
+
+void Simulation::tick(float dt) {
+    deltaTime = dt;
+    calculatePhysics();
+    ticks++;
+    simTime += dt;
+    if (deterministic) hashState();
+    if (recorder && recorder->isRecording()) {
+        if (updateListDirty) rebuildUpdateList();
+        recorder->captureTick(orderedComponents);
+    }
+}
+
+void Simulation::setHierarchy(Hierarchy* h) {
+    hierarchy = h;
+}
+
+void Simulation::setWorkerCount(int count) {
+    delete jobs;
+    jobs = new JobSystem(count);
+}
+
+void Simulation::resetSchedulerStats() {
+    stats = SchedulerStats();
+}
+
+void Simulation::setDeterministic(bool enabled, quint64 seed) {
+    deterministic = enabled;
+    rng.seed(seed);
+    ticks = 0;
+    simTime = 0;
+    lastStateHash = 0;
+    hashOrderChanged = true;
+}
+
+// Built from the raw 53 bits instead of a std distribution, whose output
+// differs between standard libraries
+double Simulation::random() {
+    return (rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Components are kept in entity ID order so the parallel phases, the
+// spatial index and the state hash see the same sequence on every run
+void Simulation::rebuildUpdateList() {
+    std::vector<std::pair<const std::string*, PhysicsComponent*>> sorted;
+    sorted.reserve(physicsComponent.size());
+    for (auto& [id, comp] : physicsComponent) sorted.push_back({&id, &comp});
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return *a.first < *b.first; });
+
+    orderedComponents.clear();
+    updateList.clear();
+    idHashes.clear();
+    for (const auto& [id, comp] : sorted) {
+        orderedComponents.push_back(comp);
+        if (comp->transform && comp->rigidbody) updateList.push_back(comp);
+        quint64 h = HASH_OFFSET;
+        for (char c : *id) hashWord(h, static_cast<quint8>(c));
+        idHashes.push_back(h);
+    }
+    updateListDirty = false;
+    orderRevision++;
+    hashOrderChanged = true;
+}
+
+// Per-entity hash of transform, rigidbody and Bullet body state, folded in
+// ID order into one world hash
+void Simulation::hashState() {
+    if (updateListDirty) rebuildUpdateList();
+
+    entityHashes.resize(orderedComponents.size());
+    quint64 world = HASH_OFFSET;
+    for (size_t i = 0; i < orderedComponents.size(); ++i) {
+        const PhysicsComponent* comp = orderedComponents[i];
+        quint64 h = HASH_OFFSET;
+        if (comp->transform) {
+            hashVector(h, comp->transform->translation());
+            const QQuaternion q = comp->transform->rotation();
+            hashFloat(h, q.scalar());
+            hashFloat(h, q.x());
+            hashFloat(h, q.y());
+            hashFloat(h, q.z());
+            hashVector(h, comp->transform->scale3D());
+        }
+        if (comp->rigidbody) {
+            hashFloat(h, comp->rigidbody->velocity->x);
+            hashFloat(h, comp->rigidbody->velocity->y);
+            hashFloat(h, comp->rigidbody->velocity->z);
+            hashFloat(h, comp->rigidbody->angularVelocity->x);
+            hashFloat(h, comp->rigidbody->angularVelocity->y);
+            hashFloat(h, comp->rigidbody->angularVelocity->z);
+        }
+        auto it = comp->entity ? bulletBodies.find(comp->entity->ID) : bulletBodies.end();
+        if (it != bulletBodies.end()) {
+            const btTransform& t = it->second->getWorldTransform();
+            const btQuaternion r = t.getRotation();
+            hashFloat(h, t.getOrigin().x());
+            hashFloat(h, t.getOrigin().y());
+            hashFloat(h, t.getOrigin().z());
+            hashFloat(h, r.x());
+            hashFloat(h, r.y());
+            hashFloat(h, r.z());
+            hashFloat(h, r.w());
+            hashFloat(h, it->second->getLinearVelocity().x());
+            hashFloat(h, it->second->getLinearVelocity().y());
+            hashFloat(h, it->second->getLinearVelocity().z());
+            hashFloat(h, it->second->getAngularVelocity().x());
+            hashFloat(h, it->second->getAngularVelocity().y());
+            hashFloat(h, it->second->getAngularVelocity().z());
+        }
+        entityHashes[i] = h;
+
+        hashWord(world, static_cast<quint32>(idHashes[i]));
+        hashWord(world, static_cast<quint32>(idHashes[i] >> 32));
+        hashWord(world, static_cast<quint32>(h));
+        hashWord(world, static_cast<quint32>(h >> 32));
+    }
+    lastStateHash = world;
+
+    if (hashLog) {
+        if (hashOrderChanged) {
+            std::vector<std::string> ids;
+            ids.reserve(orderedComponents.size());
+            for (const PhysicsComponent* comp : orderedComponents) ids.push_back(comp->entity ? comp->entity->ID : std::string());
+            hashLog->writeEntityOrder(ids);
+        }
+        hashLog->writeTick(ticks, lastStateHash, entityHashes);
+    }
+    hashOrderChanged = false;
+    emit stateHashed(ticks, lastStateHash);
 }
 
 int Simulation::getRate() const {
@@ -166,6 +354,12 @@ void Simulation::replay() {
     }
 }
 
+void Simulation::refreshViews() {
+    if (viewSyncEnabled) kinematics.syncViews();
+    emit Update();
+    emit Render(0.0f);
+}
+
 // Public: Replay with provided frames
 void Simulation::replay(const QVector<QJsonObject>& frames) {
     isReplaying = true;
@@ -190,9 +384,9 @@ void Simulation::handleReplayFrame(const QJsonObject& frame) {
                 QJsonObject pos = entity["position"].toObject();
                 QJsonObject rot = entity["rotation"].toObject();
 
-                comp.transform->matrix->translation().setX(pos["x"].toDouble());
-                comp.transform->matrix->translation().setY(pos["y"].toDouble());
-                comp.transform->matrix->translation().setZ(pos["z"].toDouble());
+                comp.transform->translation().setX(pos["x"].toDouble());
+                comp.transform->translation().setY(pos["y"].toDouble());
+                comp.transform->translation().setZ(pos["z"].toDouble());
 
                 comp.transform->toEulerAngles().setX(rot["x"].toDouble());
                 comp.transform->toEulerAngles().setY(rot["y"].toDouble());
@@ -221,28 +415,23 @@ void Simulation::entityAdded(QString /*parentID*/, Entity* entity) {
     component.collider = platform->collider;
     component.dynamicModel = platform->dynamicModel;
 
+    if (component.rigidbody) component.rigidbodyRevision = component.rigidbody->revision;
+    if (component.collider) component.colliderRevision = component.collider->revision;
+    if (component.transform) component.transformRevision = component.transform->revision;
     physicsComponent[platform->ID] = component;
+    updateListDirty = true;
+    if (platform->transform) kinematics.attach(platform->transform);
 
     if (platform->transform && platform->rigidbody) {
-        btCollisionShape* shape = nullptr;
-
-        if (platform->collider && platform->collider->collider == Constants::ColliderType::Box) {
-            shape = new btBoxShape(btVector3(1, 1, 1));
-            shape->setLocalScaling(btVector3(
-                platform->transform->matrix->scale3D().x() * platform->collider->Width * 0.5f,
-                platform->transform->matrix->scale3D().y() * platform->collider->Length * 0.5f,
-                platform->transform->matrix->scale3D().z() * platform->collider->Height * 0.5f));
-        } else if (platform->collider && platform->collider->collider == Constants::ColliderType::Sphere) {
-            shape = new btSphereShape(platform->collider->Radius * platform->transform->matrix->scale3D().length());
-        }
+        btCollisionShape* shape = acquireShape(component);
 
         if (shape) {
             btTransform transform;
             transform.setIdentity();
             transform.setOrigin(btVector3(
-                platform->transform->matrix->translation().x(),
-                platform->transform->matrix->translation().y(),
-                platform->transform->matrix->translation().z()));
+                platform->transform->translation().x(),
+                platform->transform->translation().y(),
+                platform->transform->translation().z()));
             btQuaternion quat;
             quat.setEulerZYX(
                 qDegreesToRadians(platform->transform->toEulerAngles().z()),
@@ -280,10 +469,12 @@ void Simulation::entityAdded(QString /*parentID*/, Entity* entity) {
 
             connect(platform->rigidbody, &Rigidbody::setLinearVel, this, [body](const Vector& velocity) {
                 body->setLinearVelocity(btVector3(velocity.x, velocity.y, velocity.z));
+                body->activate(true);
             });
 
             connect(platform->rigidbody, &Rigidbody::setAngularVel, this, [body](const Vector& velocity) {
                 body->setAngularVelocity(btVector3(velocity.x, velocity.y, velocity.z));
+                body->activate(true);
             });
 
             btVector3 linearFactor(1, 1, 1);
@@ -315,7 +506,7 @@ void Simulation::entityRemoved(QString ID) {
         if (body) {
             dynamicsWorld->removeRigidBody(body);
             delete body->getMotionState();
-            delete body->getCollisionShape();
+            shapeCache.release(body->getCollisionShape());
             delete body;
         }
         bulletBodies.erase(bulletIt);
@@ -323,86 +514,164 @@ void Simulation::entityRemoved(QString ID) {
 
     auto physIt = physicsComponent.find(key);
     if (physIt != physicsComponent.end()) {
+        if (physIt->second.transform) kinematics.detach(physIt->second.transform);
         physicsComponent.erase(physIt);
+        updateListDirty = true;
     }
 
     emit HierarchyUpdate();
 }
 
+// Advances the world by exactly deltaTime; the scheduler owns substepping
 void Simulation::calculatePhysics() {
-    const float dt = deltaTime * speed;
-    const float maxDt = 1.0f / PhysicsUpdateFrameRate;
-    const float clampedDt = std::min(dt, maxDt);
+    const float dt = deltaTime;
 
-    dynamicsWorld->stepSimulation(clampedDt, 10);
+    dynamicsWorld->stepSimulation(dt, 1, dt);
     emit Physics();
 
-    for (auto& [id, comp] : physicsComponent) {
-        if (!comp.transform || !comp.rigidbody) continue;
-        comp.rigidbody->deltaTime = deltaTime;
-        if (comp.dynamicModel) comp.dynamicModel->Update(dt);
-        if (comp.entity) comp.entity->update();
+    // Write phase: every job moves only its own entities' kinematic slots.
+    // Workers are used only while views are deferred, since otherwise each
+    // transform write would also touch its Qt3D view.
+    if (updateListDirty) rebuildUpdateList();
+    const int count = static_cast<int>(updateList.size());
+    const int grain = kinematics.deferViews() ? PARALLEL_GRAIN : count;
+    jobs->parallelFor(count, grain, [this, dt](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            PhysicsComponent* comp = updateList[i];
+            comp->rigidbody->deltaTime = dt;
+            if (comp->dynamicModel) comp->dynamicModel->Update(dt);
+        }
+    });
 
-        auto it = bulletBodies.find(id);
+    // Bullet is single threaded: body sync stays on this thread, in ID order
+    // like the update path
+    for (PhysicsComponent* simulated : updateList) {
+        PhysicsComponent& comp = *simulated;
+        auto it = comp.entity ? bulletBodies.find(comp.entity->ID) : bulletBodies.end();
         if (it != bulletBodies.end()) {
             btRigidBody* body = it->second;
-            btTransform trans;
-            body->getMotionState()->getWorldTransform(trans);
-
-            btVector3 pos = trans.getOrigin();
-            btQuaternion rot = trans.getRotation();
-            // comp.transform->position->x = pos.getX();
-            // comp.transform->position->y = pos.getY();
-            // comp.transform->position->z = pos.getZ();
-
-            btScalar x, y, z;
-            rot.getEulerZYX(z, y, x);
-            // comp.transform->rotation->x = qRadiansToDegrees(x);
-            // comp.transform->rotation->y = qRadiansToDegrees(y);
-            // comp.transform->rotation->z = qRadiansToDegrees(z);
-
-            if (comp.collider) {
-                body->getCollisionShape()->setLocalScaling(btVector3(
-                    comp.transform->matrix->scale3D().x() * comp.collider->Width * 0.5f,
-                    comp.transform->matrix->scale3D().y() * comp.collider->Length * 0.5f,
-                    comp.transform->matrix->scale3D().z() * comp.collider->Height * 0.5f));
-            }
 
-            if (comp.rigidbody->Gravity) {
-                body->setGravity(btVector3(Gravity->x, Gravity->y, Gravity->z));
-            } else {
-                body->setGravity(btVector3(0, 0, 0));
+            // Only push properties that changed since the last sync
+            if (comp.rigidbody->revision != comp.rigidbodyRevision) {
+                applyRigidbody(body, comp.rigidbody);
+                comp.rigidbodyRevision = comp.rigidbody->revision;
+            }
+            if (comp.collider && (comp.collider->revision != comp.colliderRevision ||
+                                  comp.transform->revision != comp.transformRevision)) {
+                applyShapeScaling(body, comp);
+                comp.colliderRevision = comp.collider->revision;
+                comp.transformRevision = comp.transform->revision;
             }
 
-            comp.rigidbody->velocity->x = body->getLinearVelocity().x();
-            comp.rigidbody->velocity->y = body->getLinearVelocity().y();
-            comp.rigidbody->velocity->z = body->getLinearVelocity().z();
-
-            comp.rigidbody->angularVelocity->x = body->getAngularVelocity().x();
-            comp.rigidbody->angularVelocity->y = body->getAngularVelocity().y();
-            comp.rigidbody->angularVelocity->z = body->getAngularVelocity().z();
+            // Sleeping bodies keep the velocities they went to sleep with
+            if (!body->isActive()) continue;
 
-            btVector3 linearFactor(1, 1, 1);
-            if (comp.rigidbody->freezePositionX) linearFactor.setX(0);
-            if (comp.rigidbody->freezePositionY) linearFactor.setY(0);
-            if (comp.rigidbody->freezePositionZ) linearFactor.setZ(0);
-            body->setLinearFactor(linearFactor);
+            const btVector3& linear = body->getLinearVelocity();
+            const btVector3& angular = body->getAngularVelocity();
+            comp.rigidbody->velocity->x = linear.x();
+            comp.rigidbody->velocity->y = linear.y();
+            comp.rigidbody->velocity->z = linear.z();
 
-            btVector3 angularFactor(1, 1, 1);
-            if (comp.rigidbody->freezeRotationX) angularFactor.setX(0);
-            if (comp.rigidbody->freezeRotationY) angularFactor.setY(0);
-            if (comp.rigidbody->freezeRotationZ) angularFactor.setZ(0);
-            body->setAngularFactor(angularFactor);
+            comp.rigidbody->angularVelocity->x = angular.x();
+            comp.rigidbody->angularVelocity->y = angular.y();
+            comp.rigidbody->angularVelocity->z = angular.z();
 
-            if (comp.rigidbody->Kinematics) {
-                body->setCollisionFlags(body->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
-                body->setActivationState(DISABLE_DEACTIVATION);
-            } else {
-                body->setCollisionFlags(body->getCollisionFlags() & ~btCollisionObject::CF_KINEMATIC_OBJECT);
-                body->setActivationState(ACTIVE_TAG);
+            if (comp.transform->kinematicStore == &kinematics) {
+                kinematics.velocities[comp.transform->kinematicSlot] = QVector3D(linear.x(), linear.y(), linear.z());
             }
         }
     }
+
+    // Read phase: sensor scans start after the write phase has finished and
+    // only read other entities' state, writing just their own track tables.
+    // The index is invalidated afterwards so nothing outside the tick queries
+    // stale pointers; its cells are kept for the next rebuild.
+    if (hierarchy) hierarchy->rebuildSpatialIndex();
+    jobs->parallelFor(count, grain, [this](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            if (updateList[i]->entity) updateList[i]->entity->update();
+        }
+    });
+    if (hierarchy) hierarchy->spatialIndex.invalidate();
+    publishTrackDeltas();
+}
+
+// Scans only queue their changes; subscribers hear about them here, on the
+// simulation thread, so their work follows what changed
+void Simulation::publishTrackDeltas() {
+    for (PhysicsComponent* comp : updateList) {
+        if (!comp->entity) continue;
+        for (Sensor* sensor : comp->entity->sensorList) {
+            if (!sensor || sensor->trackDeltas.empty()) continue;
+            emit sensorTracksChanged(sensor, sensor->trackDeltas);
+            sensor->publishDeltas();
+        }
+    }
+}
+
+void Simulation::applyRigidbody(btRigidBody* body, Rigidbody* rigidbody) {
+    if (rigidbody->Gravity) {
+        body->setGravity(btVector3(Gravity->x, Gravity->y, Gravity->z));
+    } else {
+        body->setGravity(btVector3(0, 0, 0));
+    }
+
+    btVector3 linearFactor(1, 1, 1);
+    if (rigidbody->freezePositionX) linearFactor.setX(0);
+    if (rigidbody->freezePositionY) linearFactor.setY(0);
+    if (rigidbody->freezePositionZ) linearFactor.setZ(0);
+    body->setLinearFactor(linearFactor);
+
+    btVector3 angularFactor(1, 1, 1);
+    if (rigidbody->freezeRotationX) angularFactor.setX(0);
+    if (rigidbody->freezeRotationY) angularFactor.setY(0);
+    if (rigidbody->freezeRotationZ) angularFactor.setZ(0);
+    body->setAngularFactor(angularFactor);
+
+    if (rigidbody->Kinematics) {
+        body->setCollisionFlags(body->getCollisionFlags() | btCollisionObject::CF_KINEMATIC_OBJECT);
+        body->setActivationState(DISABLE_DEACTIVATION);
+    } else {
+        body->setCollisionFlags(body->getCollisionFlags() & ~btCollisionObject::CF_KINEMATIC_OBJECT);
+        body->forceActivationState(ACTIVE_TAG);
+        body->activate(true);
+    }
+}
+
+btCollisionShape* Simulation::acquireShape(const PhysicsComponent& comp) {
+    if (!comp.collider || !comp.transform) return nullptr;
+    const QVector3D scale = comp.transform->scale3D();
+    const btVector3 halfExtents(
+        scale.x() * comp.collider->Width * 0.5f,
+        scale.y() * comp.collider->Length * 0.5f,
+        scale.z() * comp.collider->Height * 0.5f);
+    return shapeCache.acquire(comp.collider->collider, halfExtents, comp.collider->Radius * scale.length());
+}
+
+// Shared shapes are never rescaled in place: a resized collider swaps to the
+// cached shape for its new dimensions.
+void Simulation::applyShapeScaling(btRigidBody* body, const PhysicsComponent& comp) {
+    btCollisionShape* shape = acquireShape(comp);
+    if (!shape) return;
+    if (shape == body->getCollisionShape()) {
+        shapeCache.release(shape);
+        return;
+    }
+
+    shapeCache.release(body->getCollisionShape());
+    body->setCollisionShape(shape);
+
+    const btScalar mass = body->getInvMass() > 0 ? 1.0f / body->getInvMass() : 0.0f;
+    btVector3 inertia(0, 0, 0);
+    if (mass > 0) shape->calculateLocalInertia(mass, inertia);
+    body->setMassProps(mass, inertia);
+    body->updateInertiaTensor();
+
+    if (body->getBroadphaseHandle()) {
+        dynamicsWorld->getBroadphase()->getOverlappingPairCache()->cleanProxyFromPairs(body->getBroadphaseHandle(), dispatcher);
+        dynamicsWorld->updateSingleAabb(body);
+    }
+    body->activate(true);
 }
 
 void Simulation::entityUpdate(QString ID) {
@@ -421,9 +690,9 @@ void Simulation::entityUpdate(QString ID) {
         body->getMotionState()->getWorldTransform(trans);
 
         trans.setOrigin(btVector3(
-            comp.transform->matrix->translation().x(),
-            comp.transform->matrix->translation().y(),
-            comp.transform->matrix->translation().z()));
+            comp.transform->translation().x(),
+            comp.transform->translation().y(),
+            comp.transform->translation().z()));
 
         btQuaternion quat;
         quat.setEulerZYX(
@@ -433,12 +702,12 @@ void Simulation::entityUpdate(QString ID) {
         trans.setRotation(quat);
 
         body->setWorldTransform(trans);
+        body->activate(true);
 
         if (comp.collider) {
-            body->getCollisionShape()->setLocalScaling(btVector3(
-                comp.transform->matrix->scale3D().x() * comp.collider->Width * 0.5f,
-                comp.transform->matrix->scale3D().y() * comp.collider->Length * 0.5f,
-                comp.transform->matrix->scale3D().z() * comp.collider->Height * 0.5f));
+            applyShapeScaling(body, comp);
+            comp.colliderRevision = comp.collider->revision;
+            comp.transformRevision = comp.transform->revision;
         }
 
         comp.rigidbody->velocity->x = body->getLinearVelocity().x();
@@ -8,6 +8,7 @@
 #include <QElapsedTimer>
 #include <core/Hierarchy/entity.h>
 #include <core/Hierarchy/EntityProfiles/platform.h>
+#include <core/Hierarchy/EntityProfiles/sensor.h>
 #include <core/Hierarchy/Struct/vector.h>
 #include <core/Hierarchy/Components/transform.h>
 #include <core/Hierarchy/Components/collider.h>
@@ -15,6 +16,11 @@
 #include <core/Hierarchy/Components/dynamicmodel.h> // Added for DynamicModel
 #include <unordered_map>
 #include <core/Recorder/recorder.h>
+#include <core/Simulation/kinematicstore.h>
+#include <core/Simulation/collisionshapecache.h>
+#include <core/Simulation/jobsystem.h>
+#include <core/Simulation/statehashlog.h>
+#include <random>
 
 struct PhysicsComponent {
     std::string name;
@@ -23,21 +29,45 @@ struct PhysicsComponent {
     DynamicModel *dynamicModel;
     Rigidbody *rigidbody;
     Collider *collider;
+
+    // Component revisions last pushed to the Bullet body
+    quint64 rigidbodyRevision = 0;
+    quint64 colliderRevision = 0;
+    quint64 transformRevision = 0;
+};
+
+// Wall clock vs simulated time bookkeeping for the fixed-step scheduler
+struct SchedulerStats {
+    qint64 frames = 0;         // timer callbacks
+    qint64 physicsSteps = 0;   // fixed substeps executed
+    qint64 renders = 0;        // Update/Render emissions
+    qint64 catchUpClamps = 0;  // frames that hit the substep limit
+    double wallTime = 0;       // scaled wall seconds fed to the accumulator
+    double simulatedTime = 0;  // seconds advanced by physics
+    double droppedTime = 0;    // seconds discarded by the catch-up limits
+
+    // Time still waiting in the accumulator; stays below one step when keeping up
+    double drift() const { return wallTime - simulatedTime - droppedTime; }
 };
 
 class Simulation : public QObject {
     Q_OBJECT
 public:
-    Simulation();
+    explicit Simulation(int workerThreads = -1); // see setWorkerCount
     ~Simulation();
 
     Recorder* recorder = nullptr;
+    Hierarchy* hierarchy = nullptr; // owner of the spatial index used by sensors
 
     std::unordered_map<std::string, PhysicsComponent> physicsComponent;
+    KinematicStore kinematics;    // hot-path transform state, one slot per simulated entity
+    bool viewSyncEnabled = true;  // push kinematics to the Qt3D views before each Render
 
     int SimulationFrameRate;
     int PhysicsUpdateFrameRate;
     int UIUpdateFrameRate;
+    int MaxSubSteps = 8;        // physics catch-up limit per frame (at speed 1)
+    float MaxFrameTime = 0.25f; // longer stalls are dropped instead of replayed
     Vector* Gravity;
 
     bool isPlay;
@@ -54,12 +84,37 @@ public:
 
     int getRate() const;
     void calculatePhysics();
+    void tick(float dt); // one fixed step, no wall clock or UI signals; feeds the recorder while it records
+
+    void setHierarchy(Hierarchy* h);
+    void setWorkerCount(int count); // -1 = one per core, 0 = update on the calling thread only
+    const SchedulerStats& schedulerStats() const { return stats; }
+    void resetSchedulerStats();
+
+    // Lockstep mode: seeded RNG, entities visited in ID order and a 64-bit
+    // hash of the kinematic and physics state after every tick
+    void setDeterministic(bool enabled, quint64 seed = 1);
+    void seedRandom(quint64 seed) { rng.seed(seed); } // random() only; no ID ordering or hashing
+    bool isDeterministic() const { return deterministic; }
+    double random(); // uniform in [0, 1), reproducible from the seed
+    qint64 tickCount() const { return ticks; }
+    double simulatedTime() const { return simTime; } // seconds advanced by tick()
+    quint64 componentOrderRevision() const { return orderRevision; } // bumped whenever orderedComponents is rebuilt
+    quint64 stateHash() const { return lastStateHash; } // after the last tick, 0 when not deterministic
+    StateHashLog* hashLog = nullptr; // written every tick while deterministic
 
     void replay(); // newly added overload
+    void refreshViews(); // Update/Render without stepping, for replay and scrubbing
     void replay(const QVector<QJsonObject>& recordedFrames);
 
 private:
     void frame();
+    void applyRigidbody(btRigidBody* body, Rigidbody* rigidbody);
+    btCollisionShape* acquireShape(const PhysicsComponent& comp);
+    void applyShapeScaling(btRigidBody* body, const PhysicsComponent& comp);
+    void rebuildUpdateList();
+    void hashState();
+    void publishTrackDeltas();
     int rate = 1;
 
 public slots:
@@ -76,6 +131,8 @@ signals:
     void HierarchyUpdate();
     void Render(float deltaTime);
     void speedUpdated(float speed);
+    void stateHashed(qint64 tick, quint64 hash); // lockstep mode only
+    void sensorTracksChanged(Sensor* sensor, const std::vector<TrackDelta>& deltas); // once per tick per changed sensor
 
 private:
     btBroadphaseInterface* broadphase;
@@ -84,12 +141,31 @@ private:
     btSequentialImpulseConstraintSolver* solver;
     btDiscreteDynamicsWorld* dynamicsWorld;
     std::unordered_map<std::string, btRigidBody*> bulletBodies;
+    CollisionShapeCache shapeCache;
+    JobSystem* jobs;
+    std::vector<PhysicsComponent*> orderedComponents; // every component, sorted by entity ID
+    std::vector<PhysicsComponent*> updateList; // simulated subset of orderedComponents for the parallel phases
+    bool updateListDirty = true;
+    quint64 orderRevision = 0;
+
+    bool deterministic = false;
+    std::mt19937_64 rng;
+    qint64 ticks = 0;
+    double simTime = 0;
+    quint64 lastStateHash = 0;
+    std::vector<quint64> idHashes;     // per orderedComponents entry
+    std::vector<quint64> entityHashes; // per orderedComponents entry, refreshed every tick
+    bool hashOrderChanged = true;      // entity order must be re-sent to hashLog
 
     QTimer *updateTimer;
     float deltaTime;
     float speed;
     QElapsedTimer* elapsedTimer;
-    qint64 lastTime;
+    qint64 lastTime;           // ns
+    double accumulator = 0;    // simulated seconds not yet stepped
+    double renderAccumulator = 0;
+    double renderSimTime = 0;  // simulated seconds since the last Render
+    SchedulerStats stats;
 
     bool isReplaying = false;
     int replayIndex = 0;
@@ -0,0 +1,171 @@
+#include "statehashlog.h"
+#include <core/Debug/console.h>
+#include <QCommandLineParser>
+#include <sstream>
+#include <unordered_map>
+
+static const quint32 LogMagic = 0x54444648; // "TDFH"
+static const quint32 LogVersion = 1;
+static const quint8 OrderRecord = 'E';
+static const quint8 TickRecord = 'T';
+static const int MaxReported = 20; // divergent entities listed per report
+
+static std::string hex(quint64 value) {
+    std::ostringstream ss;
+    ss << std::hex << value;
+    return ss.str();
+}
+
+StateHashLog::~StateHashLog() {
+    close();
+}
+
+bool StateHashLog::open(const QString& path) {
+    close();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        Console::error("StateHashLog: failed to open " + path.toStdString());
+        return false;
+    }
+    m_stream.setDevice(&m_file);
+    m_stream << LogMagic << LogVersion;
+    return true;
+}
+
+void StateHashLog::close() {
+    if (!m_file.isOpen()) return;
+    m_stream.setDevice(nullptr);
+    m_file.close();
+}
+
+void StateHashLog::writeEntityOrder(const std::vector<std::string>& ids) {
+    if (!isOpen()) return;
+    m_stream << OrderRecord << static_cast<quint32>(ids.size());
+    for (const std::string& id : ids) m_stream << QByteArray::fromStdString(id);
+}
+
+void StateHashLog::writeTick(qint64 tick, quint64 hash, const std::vector<quint64>& entityHashes) {
+    if (!isOpen()) return;
+    m_stream << TickRecord << tick << hash << static_cast<quint32>(entityHashes.size());
+    for (quint64 h : entityHashes) m_stream << h;
+}
+
+namespace {
+// Sequential reader that keeps the most recent ID table current
+struct LogReader {
+    QFile file;
+    QDataStream stream;
+    std::vector<std::string> ids;
+    qint64 tick = 0;
+    quint64 hash = 0;
+    std::vector<quint64> entityHashes;
+
+    bool open(const QString& path) {
+        file.setFileName(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            Console::error("StateHashLog: failed to open " + path.toStdString());
+            return false;
+        }
+        stream.setDevice(&file);
+        quint32 magic = 0, version = 0;
+        stream >> magic >> version;
+        if (magic != LogMagic || version != LogVersion) {
+            Console::error("StateHashLog: " + path.toStdString() + " is not a state hash log");
+            return false;
+        }
+        return true;
+    }
+
+    // Advances to the next tick record; false at end of file
+    bool next() {
+        while (!stream.atEnd()) {
+            quint8 type = 0;
+            quint32 count = 0;
+            stream >> type;
+            if (type == OrderRecord) {
+                stream >> count;
+                ids.resize(count);
+                for (quint32 i = 0; i < count; ++i) {
+                    QByteArray id;
+                    stream >> id;
+                    ids[i] = id.toStdString();
+                }
+            } else if (type == TickRecord) {
+                stream >> tick >> hash >> count;
+                entityHashes.resize(count);
+                for (quint32 i = 0; i < count; ++i) stream >> entityHashes[i];
+                return stream.status() == QDataStream::Ok;
+            } else {
+                return false;
+            }
+        }
+        return false;
+    }
+};
+}
+
+bool StateHashLog::compare(const QString& pathA, const QString& pathB) {
+    LogReader a, b;
+    if (!a.open(pathA) || !b.open(pathB)) return false;
+
+    qint64 matched = 0;
+    while (true) {
+        const bool moreA = a.next();
+        const bool moreB = b.next();
+        if (!moreA || !moreB) {
+            if (moreA != moreB) {
+                Console::warning("Lockstep: logs match for " + std::to_string(matched) + " ticks, then " +
+                                 (moreA ? pathB : pathA).toStdString() + " ends");
+                return false;
+            }
+            Console::log("Lockstep: " + std::to_string(matched) + " ticks, no divergence");
+            return true;
+        }
+        if (a.tick == b.tick && a.hash == b.hash) {
+            matched++;
+            continue;
+        }
+        if (a.tick != b.tick) {
+            Console::error("Lockstep: tick numbering differs (" + std::to_string(a.tick) + " vs " +
+                           std::to_string(b.tick) + ") after " + std::to_string(matched) + " ticks");
+            return false;
+        }
+
+        Console::error("Lockstep: first divergence at tick " + std::to_string(a.tick) +
+                       " (" + hex(a.hash) + " vs " + hex(b.hash) + ")");
+        std::unordered_map<std::string, quint64> other;
+        for (size_t i = 0; i < b.ids.size() && i < b.entityHashes.size(); ++i) other[b.ids[i]] = b.entityHashes[i];
+        int reported = 0;
+        for (size_t i = 0; i < a.ids.size() && i < a.entityHashes.size(); ++i) {
+            auto it = other.find(a.ids[i]);
+            if (it == other.end()) {
+                if (reported++ < MaxReported) Console::error("  entity " + a.ids[i] + " only in " + pathA.toStdString());
+            } else if (it->second != a.entityHashes[i]) {
+                if (reported++ < MaxReported) Console::error("  entity " + a.ids[i] + " state differs");
+            }
+            if (it != other.end()) other.erase(it);
+        }
+        for (const auto& [id, h] : other) {
+            if (reported++ < MaxReported) Console::error("  entity " + id + " only in " + pathB.toStdString());
+        }
+        if (reported > MaxReported) Console::error("  ... and " + std::to_string(reported - MaxReported) + " more");
+        if (reported == 0) Console::error("  every entity hash matches; the entity order differs");
+        return false;
+    }
+}
+
+int StateHashLog::exec(const QStringList& arguments) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("TDF lockstep hash log comparison");
+    parser.addHelpOption();
+    parser.addOption(QCommandLineOption("compare-hashes", "Report the first divergent tick and entities of two hash logs."));
+    parser.addPositionalArgument("logs", "The two hash logs to compare.", "a.log b.log");
+    parser.process(arguments);
+
+    const QStringList logs = parser.positionalArguments();
+    if (logs.size() != 2) {
+        Console::error("StateHashLog: --compare-hashes needs exactly two hash logs");
+        return 1;
+    }
+    return compare(logs[0], logs[1]) ? 0 : 1;
+}
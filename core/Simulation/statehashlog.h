@@ -0,0 +1,38 @@
+#ifndef STATEHASHLOG_H
+#define STATEHASHLOG_H
+
+#include <QDataStream>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <string>
+#include <vector>
+
+// Binary per-tick log of lockstep state hashes. Each tick stores the world
+// hash and one hash per entity in ID order; the ID table is only written
+// when the entity set changes. Two logs (two runs, or server and client)
+// are compared with compare(), which names the first divergent tick and
+// the entities whose state differs there.
+class StateHashLog
+{
+public:
+    ~StateHashLog();
+
+    bool open(const QString& path);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    void writeEntityOrder(const std::vector<std::string>& ids);
+    void writeTick(qint64 tick, quint64 hash, const std::vector<quint64>& entityHashes);
+
+    // Returns true when both logs hold the same ticks with the same hashes
+    static bool compare(const QString& pathA, const QString& pathB);
+    // "--compare-hashes a.log b.log" on the headless entry point
+    static int exec(const QStringList& arguments);
+
+private:
+    QFile m_file;
+    QDataStream m_stream;
+};
+
+#endif // STATEHASHLOG_H
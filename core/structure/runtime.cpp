@@ -20,6 +20,7 @@ Runtime::Runtime() {
     connect(simulation,&Simulation::Render,scenerenderer,&SceneRenderer::Render);
 
     // Physics system connections
+    simulation->setHierarchy(hierarchy);
     connect(hierarchy,&Hierarchy::entityPhysicsAdded,simulation,&Simulation::entityAdded);
     connect(hierarchy,&Hierarchy::entityPhysicsRemoved,simulation,&Simulation::entityRemoved);
     connect(hierarchy,&Hierarchy::entityUpdate,simulation,&Simulation::entityUpdate);
@@ -59,10 +60,12 @@ Runtime::Runtime() {
     connect(hierarchy, &Hierarchy::entityPhysicsRemoved,
             networkManager, &NetworkManager::entityPhysicsRemoved);
 
-    connect(simulation, &Simulation::Update,
-            networkManager, &NetworkManager::UpdateClient);
+    connect(simulation, &Simulation::sensorTracksChanged,
+            networkManager, &NetworkManager::sensorTracksChanged);
 
     connect(networkManager,&NetworkManager::initData,hierarchy,&Hierarchy::fromJson);
+    connect(networkManager,&NetworkManager::initProfile,hierarchy,&Hierarchy::profileFromJson);
+    connect(networkManager,&NetworkManager::retainProfiles,hierarchy,&Hierarchy::retainProfiles);
     connect(networkManager,&NetworkManager::getCurrentJsonData,hierarchy,&Hierarchy::getCurrentJsonData);
     connect(hierarchy,&Hierarchy::getJsonData,networkManager,&NetworkManager::getJsonData);
     connect(networkManager,&NetworkManager::addFolder,hierarchy,&Hierarchy::addFolderViaNetwork);
@@ -2,12 +2,20 @@
 
 #include "GUI/mainwindow.h"
 #include <QApplication>
+#include <QCoreApplication>
 #include "core/Debug/console.h"
+#include "core/Simulation/batchrunner.h"
 
 void customMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
 
 int main(int argc, char *argv[])
 {
+    // Headless scenario sweeps: no QApplication, no widgets
+    if (BatchRunner::isBatchInvocation(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return BatchRunner::exec(app.arguments());
+    }
+
     QApplication a(argc, argv);
     qInstallMessageHandler(customMessageHandler);
     MainWindow w;